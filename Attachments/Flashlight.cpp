@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "Flashlight.h"
+#include "../GamePlugin.h"
 
 #include <CrySystem/IProjectManager.h>
 #include <CryGame/IGameFramework.h>
@@ -128,20 +129,32 @@ void CFlashlightComponent::LoadFlashlight()
 
 	flashlight.m_fFogRadialLobe = m_options.m_fogRadialLobe;
 
+	CGameAssets& assets = CGamePlugin::GetInstance()->GetAssets();
+
 	const char* szProjectorTexturePath = m_projectorOptions.GetTexturePath();
 	if (szProjectorTexturePath[0] == '\0')
 	{
 		szProjectorTexturePath = "%ENGINE%/EngineAssets/Textures/lights/flashlight_projector.dds";
-	}
 
-	const char* pExt = PathUtil::GetExt(szProjectorTexturePath);
-	if (!stricmp(pExt, "swf") || !stricmp(pExt, "gfx") || !stricmp(pExt, "usm") || !stricmp(pExt, "ui"))
-	{
-		flashlight.m_pLightDynTexSource = gEnv->pRenderer->EF_LoadDynTexture(szProjectorTexturePath, false);
+		// Default projector is kept resident, the light releases its reference when it is freed
+		if (ITexture* pProjectorTexture = assets.GetProjectorTexture())
+		{
+			pProjectorTexture->AddRef();
+			flashlight.m_pLightImage = pProjectorTexture;
+		}
 	}
-	else
+
+	if (flashlight.m_pLightImage == nullptr)
 	{
-		flashlight.m_pLightImage = gEnv->pRenderer->EF_LoadTexture(szProjectorTexturePath, FT_DONT_STREAM);
+		const char* pExt = PathUtil::GetExt(szProjectorTexturePath);
+		if (!stricmp(pExt, "swf") || !stricmp(pExt, "gfx") || !stricmp(pExt, "usm") || !stricmp(pExt, "ui"))
+		{
+			flashlight.m_pLightDynTexSource = gEnv->pRenderer->EF_LoadDynTexture(szProjectorTexturePath, false);
+		}
+		else
+		{
+			flashlight.m_pLightImage = gEnv->pRenderer->EF_LoadTexture(szProjectorTexturePath, FT_DONT_STREAM);
+		}
 	}
 
 	if ((flashlight.m_pLightImage == nullptr || !flashlight.m_pLightImage->IsTextureLoaded()) && flashlight.m_pLightDynTexSource == nullptr)
@@ -157,7 +170,7 @@ void CFlashlightComponent::LoadFlashlight()
 	if (m_projectorOptions.HasMaterialPath())
 	{
 		// Allow setting a specific material for the flashlight in this slot, for example to set up beams
-		if (IMaterial* pMaterial = gEnv->p3DEngine->GetMaterialManager()->LoadMaterial(m_projectorOptions.GetMaterialPath(), false))
+		if (IMaterial* pMaterial = assets.GetMaterial(m_projectorOptions.GetMaterialPath()))
 		{
 			m_pEntity->SetSlotMaterial(GetEntitySlotId(), pMaterial);
 		}
@@ -168,7 +181,7 @@ void CFlashlightComponent::LoadFlashlight()
 	//m_pEntity->SetSlotLocalTM(GetEntitySlotId(), Matrix34::Create(Vec3(1.f), Quat::CreateRotationY(gf_PI * -0.5f), ZERO));
 
 
-	//m_pEntity->SetRotation(m_pPlayer->m_lookOrientation);
+	//m_pEntity->SetRotation(m_pPlayer->m_lookAngles.GetOrientation());
 
 	uint32 slotFlags = m_pEntity->GetSlotFlags(GetEntitySlotId());
 	//UpdateGIModeEntitySlotFlags((uint8)m_options.m_giMode, slotFlags);
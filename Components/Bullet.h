@@ -1,7 +1,12 @@
 #pragma once
 
+#include "../GamePlugin.h"
+#include "../Systems/ProjectilePool.h"
+#include "../Systems/ProjectileTypes.h"
+
 ////////////////////////////////////////////////////////
-// Physicalized bullet shot from weaponry, expires on collision with another object
+// Physicalized bullet shot from weaponry, expires on collision according to the projectile impact policy
+// Bullets are owned by CProjectilePool, which re-arms them through Launch instead of spawning a new entity per shot
 ////////////////////////////////////////////////////////
 class CBulletComponent final : public IEntityComponent
 {
@@ -11,38 +16,33 @@ public:
 	// IEntityComponent
 	virtual void Initialize() override
 	{
-		// Set the model
+		CGameAssets& assets = CGamePlugin::GetInstance()->GetAssets();
+
+		// Set the model, preloaded by CGameAssets
 		const int geometrySlot = 0;
-		m_pEntity->LoadGeometry(geometrySlot, "Objects/Default/primitive_sphere.cgf");
+		m_pEntity->SetStatObj(assets.GetGeometry(CGameAssets::EGeometry::BulletSphere), geometrySlot, false);
 
-		// Load the custom bullet material.
+		// Use the custom bullet material.
 		// This material has the 'mat_bullet' surface type applied, which is set up to play sounds on collision with 'mat_default' objects in Libs/MaterialEffects
-		auto *pBulletMaterial = gEnv->p3DEngine->GetMaterialManager()->LoadMaterial("Materials/bullet");
-		m_pEntity->SetMaterial(pBulletMaterial);
+		m_pEntity->SetMaterial(assets.GetBulletMaterial());
 
 		// Now create the physical representation of the entity
 		SEntityPhysicalizeParams physParams;
 		physParams.type = PE_RIGID;
-		physParams.mass = 2000.f;
+		physParams.mass = Projectile::GetMass(Projectile::EType::Bullet);
 		m_pEntity->Physicalize(physParams);
 
+		// Collisions drive the projectile impact policy, make sure physics reports them
+		if (auto *pPhysics = m_pEntity->GetPhysics())
+		{
+			pe_params_flags flagParams;
+			flagParams.flagsOR = pef_log_collisions;
+			pPhysics->SetParams(&flagParams);
+		}
+
 		// Make sure that bullets are always rendered regardless of distance
 		// Ratio is 0 - 255, 255 being 100% visibility
 		GetEntity()->SetViewDistRatio(255);
-
-		// Apply an impulse so that the bullet flies forward
-		if (auto *pPhysics = GetEntity()->GetPhysics())
-		{
-			pe_action_impulse impulseAction;
-
-			const float initialVelocity = -10.f;
-
-			// Set the actual impulse, in this cause the value of the initial velocity CVar in bullet's forward direction
-			impulseAction.impulse = GetEntity()->GetWorldRotation().GetColumn1() * initialVelocity;
-
-			// Send to the physical entity
-			pPhysics->Action(&impulseAction);
-		}
 	}
 
 	// Reflect type to set a unique identifier for this component
@@ -54,16 +54,48 @@ public:
 	virtual uint64 GetEventMask() const override { return BIT64(ENTITY_EVENT_COLLISION); }
 	virtual void ProcessEvent(SEntityEvent& event) override
 	{
-		// Handle the OnCollision event, in order to have the entity removed on collision
+		// Handle the OnCollision event, in order to have the bullet returned to the pool on impact
 		if (event.event == ENTITY_EVENT_COLLISION)
 		{
-			// Collision info can be retrieved using the event pointer
-			//EventPhysCollision *physCollision = reinterpret_cast<EventPhysCollision *>(event.ptr);
-			EventPhysCollision *pCollision = reinterpret_cast<EventPhysCollision*>(event.nParam[0]);
-			//CryLog("collision, %i", pCollision->idCollider);
-			// Queue removal of this entity, unless it has already been done
-			//gEnv->pEntitySystem->RemoveEntity(GetEntityId());
+			// Queue expiry of this bullet, the lifetime manager decides whether this impact ends its flight
+			if (m_pPool != nullptr)
+			{
+				m_pPool->OnImpact(m_poolSlot);
+			}
 		}
 	}
 	// ~IEntityComponent
+
+	// Moves the bullet into place, makes it visible and sets its mass and velocity in m/s
+	void Launch(const QuatTS& transform, const Vec3& velocity, float mass)
+	{
+		m_pEntity->SetPosRotScale(transform.t, transform.q, Vec3(transform.s));
+		m_pEntity->Hide(false);
+		m_pEntity->EnablePhysics(true);
+
+		if (auto *pPhysics = m_pEntity->GetPhysics())
+		{
+			// Pooled bullets also fly as stones, impacts report the mass of the projectile type
+			pe_simulation_params simulationParams;
+			simulationParams.mass = mass;
+			pPhysics->SetParams(&simulationParams);
+
+			// Replaces any motion left over from the previous flight
+			pe_action_set_velocity velocityAction;
+			velocityAction.v = velocity;
+			velocityAction.w = ZERO;
+			pPhysics->Action(&velocityAction);
+		}
+	}
+
+	// Parks the bullet until the pool launches it again
+	void Disarm()
+	{
+		m_pEntity->EnablePhysics(false);
+		m_pEntity->Hide(true);
+	}
+
+	// Pool owning this bullet, and the slot it occupies
+	CProjectilePool* m_pPool = nullptr;
+	uint32 m_poolSlot = CProjectilePool::InvalidSlot;
 };
@@ -1,4 +1,5 @@
 #include "DestroyableComponent.h"
+#include "../GamePlugin.h"
 #include <CrySchematyc/Env/IEnvRegistrar.h>
 #include <CrySchematyc/Env/Elements/EnvComponent.h>
 
@@ -42,13 +43,16 @@ void CDestroyableComponent::ProcessEvent(SEntityEvent & event)
 
 		break;
 	case ENTITY_EVENT_COLLISION:
+	{
 		if (event.nParam[1] == 0)
 			break;
+		GAME_PROFILE_SCOPE("Destroyable::Collision");
 		pCollision = reinterpret_cast<EventPhysCollision*>(event.nParam[0]);
-		CryLog("mass is %f", pCollision->mass[0]);
+		CEventLog::Write(EventLog::EEvent::DestroyableHit, GetEntityId(), pCollision->mass[0], m_life);
+		CSessionRecorder::RecordCollision(GetEntityId(), pCollision->pt, pCollision->mass[0]);
 		DecrementLife(pCollision->mass[0]);
-
-		break;
+	}
+	break;
 	case ENTITY_EVENT_START_GAME:
 		Reset();
 		break;
@@ -79,7 +83,8 @@ void CDestroyableComponent::DecrementLife(float bulletMass)
 		m_alive = false;
 		return;
 	}
-	if (bulletMass == 0.25f && m_alive)
+	// Only bullets do damage, recognized by their mass in both projectile modes
+	if (bulletMass == Projectile::GetMass(Projectile::EType::Bullet) && m_alive)
 		m_life -= 1.0f;
 }
 
@@ -88,7 +93,8 @@ void CDestroyableComponent::DestroyObject(Schematyc::GeomFileName pathToDestroye
 	GetEntity()->FreeSlot(0);
 	GetEntity()->UnphysicalizeSlot(0);
 
-	GetEntity()->LoadGeometry(0, m_destroyedGeomPath.value);
+	// Resolved from the resident asset handles, no path lookup unless the property points to a custom asset
+	GetEntity()->SetStatObj(CGamePlugin::GetInstance()->GetAssets().GetGeometry(pathToDestroyedObject.value), 0, false);
 
 	SEntityPhysicalizeParams params;
 	params.type = PE_RIGID;
@@ -131,7 +137,7 @@ void CDestroyableComponent::Reset()
 	GetEntity()->FreeSlot(0);
 	GetEntity()->UnphysicalizeSlot(0);
 
-	GetEntity()->LoadGeometry(0, m_intactGeomPath.value);
+	GetEntity()->SetStatObj(CGamePlugin::GetInstance()->GetAssets().GetGeometry(m_intactGeomPath.value), 0, false);
 
 	SEntityPhysicalizeParams params;
 	params.type = PE_RIGID;
@@ -3,9 +3,29 @@
 
 #include "Bullet.h"
 #include "SpawnPoint.h"
+#include "../GamePlugin.h"
+#include "../Systems/PlayerPool.h"
 
 #include <CryRenderer/IRenderAuxGeom.h>
 
+namespace
+{
+	const char* const szCharacterFile = "Objects/Characters/mixamo/pants_guy.cdf";
+	const char* const szDatabaseFile = "Animations/Mannequin/ADB/FirstPerson.adb";
+	const char* const szControllerDefinitionFile = "Animations/Mannequin/ADB/FirstPersonControllerDefinition.xml";
+}
+
+CPlayerComponent::~CPlayerComponent()
+{
+	// Pending rays and streamed files call back into our members
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetRaycasts().Cancel(this);
+		pPlugin->GetCharacterStreamer().Cancel(this);
+		pPlugin->GetPlayerUpdate().Unregister(*this);
+	}
+}
+
 void CPlayerComponent::Initialize()
 {
 	
@@ -21,10 +41,10 @@ void CPlayerComponent::Initialize()
 	m_pAnimationComponent = m_pEntity->GetOrCreateComponent<Cry::DefaultComponents::CAdvancedAnimationComponent>();
 	
 	// Set the player geometry, this also triggers physics proxy creation
-	m_pAnimationComponent->SetMannequinAnimationDatabaseFile("Animations/Mannequin/ADB/FirstPerson.adb");
-	m_pAnimationComponent->SetCharacterFile("Objects/Characters/mixamo/pants_guy.cdf");
+	m_pAnimationComponent->SetMannequinAnimationDatabaseFile(szDatabaseFile);
+	m_pAnimationComponent->SetCharacterFile(szCharacterFile);
 
-	m_pAnimationComponent->SetControllerDefinitionFile("Animations/Mannequin/ADB/FirstPersonControllerDefinition.xml");
+	m_pAnimationComponent->SetControllerDefinitionFile(szControllerDefinitionFile);
 	m_pAnimationComponent->SetDefaultScopeContextName("FirstPersonCharacter");
 	// Queue the idle fragment to start playing immediately on next update
 	m_pAnimationComponent->SetDefaultFragmentName("Idle");
@@ -32,8 +52,58 @@ void CPlayerComponent::Initialize()
 	// Disable movement coming from the animation (root joint offset), we control this entirely via physics
 	m_pAnimationComponent->SetAnimationDrivenMotion(false);
 
+	// Get the input component, wraps access to action mapping so we can easily get callbacks when inputs are triggered
+	// Registered before loading, input pressed while the character streams in is applied on the first update
+	m_pInputComponent = m_pEntity->GetOrCreateComponent<Cry::DefaultComponents::CInputComponent>();
+
+	InitializeInput();
+	InitializeNetworking();
+
+	m_simulation.Resize(1);
+
+	m_State = ePS_Standing;
+	m_crouchPress = false;
+	m_moving = false;
+	m_canStand = true;
+	m_isWeaponDrawn = false;
+	m_gruntThrow = CryAudio::StringToId("grunt_throw");
+
+	m_spawnTime = gEnv->pTimer->GetAsyncTime();
+	m_isControllableReported = false;
+
+	// Stream the character and Mannequin files in first, the player stays a bare physics capsule until they are read
+	ICVar* pStreamedLoad = gEnv->pConsole->GetCVar("g_playerStreamedLoad");
+	CGamePlugin* pPlugin = CGamePlugin::GetInstance();
+	m_isLoading = pPlugin != nullptr && pStreamedLoad != nullptr && pStreamedLoad->GetIVal() != 0;
+	m_isStreamedLoad = m_isLoading;
+
+	if (m_isLoading)
+	{
+		pPlugin->GetCharacterStreamer().Request(this, szCharacterFile, szDatabaseFile, szControllerDefinitionFile, [this]() { LoadCharacter(); });
+	}
+	else
+	{
+		LoadCharacter();
+	}
+
+	// Pooled players wait hidden until a client connects
+	if (CPlayerPool::IsPrewarming())
+	{
+		Deactivate();
+	}
+	else
+	{
+		Revive();
+	}
+}
+
+void CPlayerComponent::LoadCharacter()
+{
 	// Load the character and Mannequin data from file
+	// After streaming, the skeleton and skins are already resident in the character manager, only the XML files are parsed
+	m_attachments.Invalidate();
 	m_pAnimationComponent->LoadFromDisk();
+	m_attachments.Update(m_pAnimationComponent->GetCharacter());
 
 	// Acquire fragment and tag identifiers to avoid doing so each update
 	m_idleFragmentId = m_pAnimationComponent->GetFragmentId("Idle");
@@ -45,30 +115,47 @@ void CPlayerComponent::Initialize()
 	m_stoneThrowId = m_pAnimationComponent->GetFragmentId("StoneThrow");
 	m_rotateTagId = m_pAnimationComponent->GetTagId("Rotate");
 
-	// Get the input component, wraps access to action mapping so we can easily get callbacks when inputs are triggered
-	m_pInputComponent = m_pEntity->GetOrCreateComponent<Cry::DefaultComponents::CInputComponent>();
-
-	InitializeInput();
 	InitializeAttachements();
 
-	m_State = ePS_Standing;
-	m_crouchPress = false;
-	m_moving = false;
-	m_standPhys = true;
-	m_crouchPhys = false;
-	m_canStand = true;
-	m_isWeaponDrawn = false;
-	m_gruntThrow = CryAudio::StringToId("grunt_throw");
+	m_attachments.SetVisible(CPlayerAttachments::EAttachment::Weapon, false);
+	m_attachments.SetVisible(CPlayerAttachments::EAttachment::Stone, false);
 
-	if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
+	if (m_isLoading)
 	{
-		auto *pBarrelOutAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("weapon");
-		pBarrelOutAttachment->HideAttachment(1);
-		auto *pStoneAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("stone");
-		pStoneAttachment->HideAttachment(1);
+		m_isLoading = false;
+
+		if (m_isPooled)
+		{
+			if (pTorchEntity != nullptr)
+				pTorchEntity->Hide(true);
+			if (pFlashlightEntity != nullptr)
+				pFlashlightEntity->Hide(true);
+		}
+		else
+		{
+			// Revive skipped the character while it was loading
+			m_pAnimationComponent->ResetCharacter();
+			m_activeFragmentId = FRAGMENT_ID_INVALID;
+		}
 	}
 
-	Revive();
+	UpdateRegistration();
+}
+
+void CPlayerComponent::UpdateRegistration()
+{
+	// Only players that can be controlled are updated, in ProcessEvent or by the batched player update
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		if (IsControllable())
+		{
+			pPlugin->GetPlayerUpdate().Register(*this);
+		}
+		else
+		{
+			pPlugin->GetPlayerUpdate().Unregister(*this);
+		}
+	}
 }
 
 uint64 CPlayerComponent::GetEventMask() const
@@ -82,212 +169,188 @@ void CPlayerComponent::ProcessEvent(SEntityEvent& event)
 	{
 	case ENTITY_EVENT_START_GAME:
 	{
-		// Revive the entity when gameplay starts
-		Revive();
+		// Revive the entity when gameplay starts, pooled players are revived once a client takes them
+		if (!m_isPooled)
+		{
+			Revive();
+		}
 	}
 	break;
 	
 	case ENTITY_EVENT_ANIM_EVENT:
 	{	
-		const AnimEventInstance* pAnimEvent = reinterpret_cast<const AnimEventInstance*>(event.nParam[0]);
-
-		if (pAnimEvent)
+		if (const AnimEventInstance* pAnimEvent = reinterpret_cast<const AnimEventInstance*>(event.nParam[0]))
 		{
-			if (pAnimEvent->m_EventName && stricmp(pAnimEvent->m_EventName, "throw") == 0)
-			{
-				PlayThrowSound();
-				CryLog("throw event");
-				if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
-				{
-					auto *pStoneAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("stone");
-					pStoneAttachment->HideAttachment(1);
-
-					if (pStoneAttachment != nullptr)
-					{
-						Vec3 dir = GetEntity()->GetWorldRotation().GetColumn1();
-						CryLog("bullet direction %f, %f, %f", dir.x, dir.y, dir.z);
-
-						Vec3 stoneOrigin = pStoneAttachment->GetAttWorldAbsolute().GetColumn3();
-						CryLog("bulletorigin %f, %f, %f", stoneOrigin.x, stoneOrigin.y, stoneOrigin.z);
-
-						SEntitySpawnParams spawnParams;
-						spawnParams.vPosition = stoneOrigin;
-						const float bulletScale = 0.1f;
-						spawnParams.vScale = Vec3(bulletScale);
-
-						// Spawn the entity
-						if (IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
-						{
-							// See Bullet.cpp, bullet is propelled in  the rotation and position the entity was spawned with
-							pEntity->CreateComponentClass<CBulletComponent>();
-							// Apply an impulse so that the bullet flies forward
-							if (auto *pPhysics = pEntity->GetPhysics())
-							{
-								pe_action_impulse impulseAction;
-
-								const float initialVelocity = 50.f;
-								// Set the actual impulse, in this cause the value of the initial velocity CVar in bullet's forward direction
-								impulseAction.impulse = dir * initialVelocity;
-
-								// Send to the physical entity
-								pPhysics->Action(&impulseAction);
-							}
-						}
-					}
-
-				}
-				
-			}
-			if (pAnimEvent->m_EventName && stricmp(pAnimEvent->m_EventName, "throwEnd") == 0)
-			{
-				m_throwAnim = false;
-				CryLog("throw event ended");
-			}
+			s_animEvents.Dispatch(*this, *pAnimEvent);
 		}
 	}
-		break;
+	break;
 	case ENTITY_EVENT_UPDATE:
 	{
+		// Updated together with all other players in the plugin update instead, see CPlayerUpdateSystem
+		if (!IsControllable() || CPlayerUpdateSystem::IsEnabled())
+			break;
+
+		GAME_PROFILE_SCOPE("Player::Update");
 		SEntityUpdateContext* pCtx = (SEntityUpdateContext*)event.nParam[0];
 
-		// Start by updating the movement request we want to send to the character controller
-		// This results in the physical representation of the character moving
-		UpdateMovementRequest(pCtx->fFrameTime);
+		for (uint32 steps = m_clock.Advance(pCtx->fFrameTime); steps > 0; --steps)
+		{
+			GatherSimulation(m_simulation, 0, m_clock.GetStepTime());
+			{
+				GAME_PROFILE_SCOPE("Player::Simulate");
+				PlayerSimulation::SimulateRange(m_simulation, 0, 1, CUserSettings::Get(), m_clock.GetStepTime());
+			}
+			ApplySimulation(m_simulation, 0, m_clock.GetStepTime());
+		}
+		UpdateFrame(pCtx->fFrameTime, m_clock.GetAlpha());
+	}
+	break;
+	}
+}
 
-		// Process mouse input to update look orientation.
-		UpdateLookDirectionRequest(pCtx->fFrameTime);
+const CAnimEventDispatcher<CPlayerComponent> CPlayerComponent::s_animEvents =
+{
+	{ "throw", &CPlayerComponent::OnThrowAnimEvent },
+	{ "throwEnd", &CPlayerComponent::OnThrowEndAnimEvent }
+};
 
-		// Update the animation state of the character
-		UpdateAnimation(pCtx->fFrameTime);
+void CPlayerComponent::OnThrowAnimEvent(const AnimEventInstance& event)
+{
+	PlayThrowSound();
+	CEventLog::Write(EventLog::EEvent::ThrowStart, GetEntityId());
+	m_attachments.SetVisible(CPlayerAttachments::EAttachment::Stone, false);
 
-		// Update the camera component offset
-		UpdateCamera(pCtx->fFrameTime);
+	if (IAttachment* pStoneAttachment = m_attachments.Get(CPlayerAttachments::EAttachment::Stone))
+	{
+		Vec3 dir = GetEntity()->GetWorldRotation().GetColumn1();
+		CEventLog::Write(EventLog::EEvent::ThrowDirection, GetEntityId(), dir.x, dir.y, dir.z);
 
-		ShootRayFromHead();
+		Vec3 stoneOrigin = pStoneAttachment->GetAttWorldAbsolute().GetColumn3();
+		CEventLog::Write(EventLog::EEvent::ThrowOrigin, GetEntityId(), stoneOrigin.x, stoneOrigin.y, stoneOrigin.z);
 
-		InitializeUpdate(m_State, pCtx->fFrameTime);
+		const float bulletScale = 0.1f;
+		const QuatTS stoneTransform(Quat(IDENTITY), stoneOrigin, bulletScale);
 
+		// Throw the stone in the player's forward direction
+		const float initialVelocity = CUserSettings::Get().stoneVelocity;
 
+		// Take a projectile from the pool or the ballistics system, see CGamePlugin::LaunchProjectile
+		if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+		{
+			pPlugin->LaunchProjectile(Projectile::EType::Stone, stoneTransform, dir * initialVelocity, GetEntityId());
+		}
 	}
-	break;
-	}
+}
+
+void CPlayerComponent::OnThrowEndAnimEvent(const AnimEventInstance& event)
+{
+	m_throwAnim = false;
+	CEventLog::Write(EventLog::EEvent::ThrowEnd, GetEntityId());
 }
 
 void CPlayerComponent::InitializeAttachements()
 {
-	if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
+	IAttachment* pTorchtAttachment = m_attachments.Get(CPlayerAttachments::EAttachment::Torch);
+	if (pTorchtAttachment != nullptr)
 	{
+		SEntitySpawnParams spawnParams;
+		spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
 
-		auto *pTorchtAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("torch");
-		if (pTorchtAttachment != nullptr)
+		// Spawn the torch
+		if (pTorchEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
 		{
-			SEntitySpawnParams spawnParams;
-			spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+			pTorch = pTorchEntity->CreateComponentClass<CTorchComponent>();
 
-			// Spawn the torch
-			if (pTorchEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
-			{
-				pTorch = pTorchEntity->CreateComponentClass<CTorchComponent>();
-
-				EntityId torchId = pTorchEntity->GetId();
-				CEntityAttachment* pTorchEntAttachment = new CEntityAttachment();
+			EntityId torchId = pTorchEntity->GetId();
+			CEntityAttachment* pTorchEntAttachment = new CEntityAttachment();
 
-				pTorchEntAttachment->SetEntityId(torchId);
-				pTorchtAttachment->AddBinding(pTorchEntAttachment);
+			pTorchEntAttachment->SetEntityId(torchId);
+			pTorchtAttachment->AddBinding(pTorchEntAttachment);
 
-				pTorch->m_color.m_color = ColorF(1.0f, 0.75f, 0.25f);
-				pTorch->m_color.m_diffuseMultiplier = 0.2f;
-				pTorch->m_animations.m_style = 34;
-				pTorch->m_animations.m_speed = 0.2;
-				pTorch->m_radius = 6.0f;
-			}
+			pTorch->m_color.m_color = ColorF(1.0f, 0.75f, 0.25f);
+			pTorch->m_color.m_diffuseMultiplier = 0.2f;
+			pTorch->m_animations.m_style = 34;
+			pTorch->m_animations.m_speed = 0.2;
+			pTorch->m_radius = 6.0f;
 		}
+	}
 
-		auto *pFlashlightAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("flashlight");
-		if (pFlashlightAttachment != nullptr)
-		{
-			SEntitySpawnParams spawnParams;
-			spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
-
-			//Spawn the flashlight
-			if (pFlashlightEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
-			{
-				pFlashlight = pFlashlightEntity->CreateComponentClass<CFlashlightComponent>();
+	IAttachment* pFlashlightAttachment = m_attachments.Get(CPlayerAttachments::EAttachment::Flashlight);
+	if (pFlashlightAttachment != nullptr)
+	{
+		SEntitySpawnParams spawnParams;
+		spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
 
-				EntityId flashlightId = pFlashlightEntity->GetId();
-				CEntityAttachment* pFlashlightEntAttachment = new CEntityAttachment();
+		//Spawn the flashlight
+		if (pFlashlightEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
+		{
+			pFlashlight = pFlashlightEntity->CreateComponentClass<CFlashlightComponent>();
 
-				pFlashlightEntAttachment->SetEntityId(flashlightId);
-				pFlashlightAttachment->AddBinding(pFlashlightEntAttachment);
+			EntityId flashlightId = pFlashlightEntity->GetId();
+			CEntityAttachment* pFlashlightEntAttachment = new CEntityAttachment();
 
-				pFlashlight->m_bActive = false;
-				pFlashlight->m_color.m_diffuseMultiplier = 3.f;
-				pFlashlight->m_options.m_attenuationBulbSize = 1.f;
-			}
+			pFlashlightEntAttachment->SetEntityId(flashlightId);
+			pFlashlightAttachment->AddBinding(pFlashlightEntAttachment);
 
+			pFlashlight->m_bActive = false;
+			pFlashlight->m_color.m_diffuseMultiplier = 3.f;
+			pFlashlight->m_options.m_attenuationBulbSize = 1.f;
 		}
 
 	}
 }
 
 
-void CPlayerComponent::UpdateMovementRequest(float frameTime)
+void CPlayerComponent::UpdateLookDirectionRequest(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime)
 {
-	InitializeMovement(frameTime);
-}
-
-void CPlayerComponent::UpdateLookDirectionRequest(float frameTime)
-{
-	const float rotationSpeed = 0.002f;
-	const float rotationLimitsMinPitch = -0.84f;
-	const float rotationLimitsMaxPitch = 1.5f;
-
-	// Apply smoothing filter to the mouse input
-	m_mouseDeltaRotation = m_mouseDeltaSmoothingFilter.Push(m_mouseDeltaRotation).Get();
-
 	// Update angular velocity metrics
-	m_horizontalAngularVelocity = (m_mouseDeltaRotation.x * rotationSpeed) / frameTime;
-	m_averagedHorizontalAngularVelocity.Push(m_horizontalAngularVelocity);
-
-	// Start with updating look orientation from the latest input
-	Ang3 ypr = CCamera::CreateAnglesYPR(Matrix33(m_lookOrientation));
+	m_horizontalAngularVelocity = batch.angularVelocities[index];
+	m_averagedHorizontalAngularVelocity.Push(m_horizontalAngularVelocity, stepTime);
 
-	// Yaw
-	ypr.x += m_mouseDeltaRotation.x * rotationSpeed;
+	m_previousLookAngles = m_lookAngles;
+	m_lookAngles = batch.lookAngles[index];
+}
 
-	// Pitch
-	// TODO: Perform soft clamp here instead of hard wall, should reduce rot speed in this direction when close to limit.
-	ypr.y = CLAMP(ypr.y + m_mouseDeltaRotation.y * rotationSpeed, rotationLimitsMinPitch, rotationLimitsMaxPitch);
+void CPlayerComponent::UpdateLookCache()
+{
+	SLookCache& cache = m_lookCache;
+	const PlayerSimulation::SLookAngles& angles = m_renderLookAngles;
 
-	// Roll (skip)
-	ypr.z = 0;
+	cache.isYawChanged = !cache.isValid || angles.yaw != cache.angles.yaw;
+	cache.isPitchChanged = !cache.isValid || angles.pitch != cache.angles.pitch;
+	if (!cache.isYawChanged && !cache.isPitchChanged)
+		return;
 
-	m_lookOrientation = Quat(CCamera::CreateOrientationYPR(ypr));
+	cache.angles = angles;
+	cache.isValid = true;
 
-	if (pFlashlight->IsEnabled())
+	if (cache.isYawChanged)
 	{
-		Vec3 vDir = m_lookOrientation.GetColumn1();
-
-		Quat currentFlashlightOrientation = Quat(pFlashlight->GetLocalTM());
-
-		Ang3 ypr_current = CCamera::CreateAnglesYPR(Matrix33(currentFlashlightOrientation));
-
-		Quat targetFlashlightOrientation = Quat::CreateRotationVDir(vDir);
-
-		Ang3 ypr_target = CCamera::CreateAnglesYPR(Matrix33(targetFlashlightOrientation));
-
-		ypr_target.x = ypr_current.x;
-		ypr_target.z = ypr_current.z;
-		ypr_target.y *= -1.f;
-
-		targetFlashlightOrientation = Quat(CCamera::CreateOrientationYPR(ypr_target));
-
-		pFlashlight->SetLocalOrientation(targetFlashlightOrientation);
+		cache.bodyOrientation = angles.GetYawOrientation();
+	}
+	if (cache.isPitchChanged)
+	{
+		cache.cameraRotation = Matrix33::CreateRotationX(angles.pitch);
+		// The flashlight slot is rotated the other way, its yaw and roll stay at the zero it was loaded with
+		cache.flashlightOrientation = Quat::CreateRotationX(-angles.pitch);
+	}
+	cache.lookOrientation = cache.bodyOrientation * Quat::CreateRotationX(angles.pitch);
+}
 
+void CPlayerComponent::UpdateFlashlight()
+{
+	if (pFlashlight == nullptr || !pFlashlight->IsEnabled())
+	{
+		m_isFlashlightOriented = false;
+		return;
 	}
 
-	// Reset the mouse delta accumulator every frame
-	m_mouseDeltaRotation = ZERO;
+	if (!m_isFlashlightOriented || m_lookCache.isPitchChanged)
+	{
+		pFlashlight->SetLocalOrientation(m_lookCache.flashlightOrientation);
+		m_isFlashlightOriented = true;
+	}
 }
 
 void CPlayerComponent::UpdateAnimation(float frameTime)
@@ -308,32 +371,9 @@ void CPlayerComponent::UpdateAnimation(float frameTime)
 
 	// Update active fragment
 	//const auto& desiredFragmentId = m_pCharacterController->IsWalking() ? m_walkFragmentId : m_idleFragmentId;
-	switch (m_State) {
-		case ePS_MovingToCrouching:
-			m_desiredFragmentId = m_crouchWalkFragmentId;
-			break;
-		case ePS_MovingToStanding:
-			m_desiredFragmentId = m_walkFragmentId;
-			break;
-		case ePS_Standing:
-			m_desiredFragmentId = m_idleFragmentId;
-			break;
-		case ePS_Crouching:
-			m_desiredFragmentId = m_crouchIdleFragmentId;
-			break;
-		case ePS_WeaponMove:
-			m_desiredFragmentId = m_walkWithWeaponId;
-			break;
-		case ePS_WeaponIdle:
-			m_desiredFragmentId = m_idleWithWeaponId;
-			break;
-		case ePS_Interuptable:
-			m_desiredFragmentId = m_stoneThrowId;
-			break;
-		default:
-			break;
-	}
-
+	// Indexed by PlayerStateMachine::EFragment, Keep leaves the current fragment
+	const FragmentID fragmentIds[] = { m_desiredFragmentId, m_idleFragmentId, m_walkFragmentId, m_crouchIdleFragmentId, m_crouchWalkFragmentId, m_idleWithWeaponId, m_walkWithWeaponId, m_stoneThrowId };
+	m_desiredFragmentId = fragmentIds[(int)PlayerStateMachine::Table.fragments[m_State]];
 
 	if (m_activeFragmentId != m_desiredFragmentId)
 	{
@@ -343,34 +383,18 @@ void CPlayerComponent::UpdateAnimation(float frameTime)
 
 	// Update entity rotation as the player turns
 	// We only want to affect Z-axis rotation, zero pitch and roll
-	Ang3 ypr = CCamera::CreateAnglesYPR(Matrix33(m_lookOrientation));
-	ypr.y = 0;
-	ypr.z = 0;
-	const Quat correctedOrientation = Quat(CCamera::CreateOrientationYPR(ypr));
-
-	// Send updated transform to the entity, only orientation changes
-	GetEntity()->SetPosRotScale(GetEntity()->GetWorldPos(), correctedOrientation, Vec3(1, 1, 1));
+	if (m_lookCache.isYawChanged)
+	{
+		// Send updated transform to the entity, only orientation changes
+		GetEntity()->SetPosRotScale(GetEntity()->GetWorldPos(), m_lookCache.bodyOrientation, Vec3(1, 1, 1));
+	}
 }
 
 void CPlayerComponent::UpdateCamera(float frameTime)
 {
 	IEntity &playerEntity = *GetEntity();
 
-	IPersistantDebug *pPD = gEnv->pGameFramework->GetIPersistantDebug();
-	if (pPD)
-	{
-		pPD->Begin("cameraVector", false);
-		pPD->AddText(500.0f, 1.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "is moving %d", m_moving);
-	}
-
-	Ang3 ypr = CCamera::CreateAnglesYPR(Matrix33(m_lookOrientation));
-
-	// Ignore z-axis rotation, that's set by CPlayerAnimations
-	ypr.x = 0;
-
-	// Start with changing view rotation to the requested mouse look orientation
-	Matrix34 localTransform = IDENTITY;
-	localTransform.SetRotation33(CCamera::CreateOrientationYPR(ypr));
+	GAME_DEBUG_DRAW(EDebugCategory::Camera, AddText, 500.0f, 1.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "is moving %d", m_moving);
 
 	Vec3 targetWorldPos = playerEntity.GetWorldPos();
 	Vec3 destination;
@@ -399,22 +423,24 @@ void CPlayerComponent::UpdateCamera(float frameTime)
 		destination += playerEntity.GetWorldRotation().GetColumn1() * -0.9f;
 		destination += playerEntity.GetWorldRotation().GetColumn2() * 2.0f;
 
-		static IPhysicalEntity* pSkipEntities[10];
-		pSkipEntities[0] = playerEntity.GetPhysics();
-
-		Vec3 dir = destination - origin;
-
-		ray_hit hit;
-		int hits = gEnv->pPhysicalWorld->RayWorldIntersection(origin, dir, ent_static | ent_sleeping_rigid | ent_rigid | ent_independent | ent_terrain,
-			rwi_stop_at_pierceable | rwi_colltype_any, &hit, 1, pSkipEntities, 2);
-
-		if (hit.pCollider)
+		// Camera boom ray, answered next frame so the result used here is one frame old
+		SRayRequest request;
+		request.origin = origin;
+		request.direction = destination - origin;
+		request.objectTypes = ent_static | ent_sleeping_rigid | ent_rigid | ent_independent | ent_terrain;
+		request.pSkipEntities[0] = playerEntity.GetPhysics();
+		request.skipEntityCount = 1;
+		request.pOwner = this;
+		request.pResult = &m_cameraRayResult;
+		CGamePlugin::GetInstance()->GetRaycasts().Submit(std::move(request));
+
+		if (m_cameraRayResult.bHit)
 		{
-			destination = hit.pt;
+			destination = m_cameraRayResult.point;
 			viewOffsetForward = -1.0f * crymath::abs(targetWorldPos.y - destination.y);
 			if (viewOffsetForward > -0.3f)
 				viewOffsetForward = -0.3f;
-			pPD->AddText(10.0f, 190.0f, 2.0f, ColorF(Vec3(0, 0, 0), 0.5f), 0.10f, "hit at %f, %f, %f", destination.x, destination.y, destination.z);
+			GAME_DEBUG_DRAW(EDebugCategory::Camera, AddText, 10.0f, 190.0f, 2.0f, ColorF(Vec3(0, 0, 0), 0.5f), 0.10f, "hit at %f, %f, %f", destination.x, destination.y, destination.z);
 
 		}
 		else
@@ -424,11 +450,19 @@ void CPlayerComponent::UpdateCamera(float frameTime)
 		//pPD->AddSphere(destination, 0.1f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f);
 	}
 
-	RayCast(destination, m_lookOrientation, playerEntity);
+	RayCast(destination, m_lookCache.lookOrientation, playerEntity);
 
-	localTransform.SetTranslation(Vec3(0, viewOffsetForward, viewOffsetUp));
+	// View rotation is the requested mouse look pitch, z-axis rotation is set by the entity
+	const Vec3 offset(0, viewOffsetForward, viewOffsetUp);
+	if (m_lookCache.isPitchChanged || offset != m_cameraOffset)
+	{
+		m_cameraOffset = offset;
 
-	m_pCameraComponent->SetTransformMatrix(localTransform);
+		Matrix34 localTransform = IDENTITY;
+		localTransform.SetRotation33(m_lookCache.cameraRotation);
+		localTransform.SetTranslation(offset);
+		m_pCameraComponent->SetTransformMatrix(localTransform);
+	}
 }
 
 
@@ -438,27 +472,53 @@ void CPlayerComponent::Revive()
 	// Find a spawn point and move the entity there
 	SpawnAtSpawnPoint();
 
-	// Unhide the entity in case hidden by the Editor
+	// Unhide the entity in case hidden by the Editor or the player pool
 	GetEntity()->Hide(false);
+	if (m_isPooled)
+	{
+		m_isPooled = false;
+
+		if (pTorchEntity != nullptr)
+			pTorchEntity->Hide(false);
+		if (pFlashlightEntity != nullptr)
+			pFlashlightEntity->Hide(false);
+
+		// Time to the first controllable frame counts from the client taking the player
+		m_spawnTime = gEnv->pTimer->GetAsyncTime();
+		m_isControllableReported = false;
+
+		UpdateRegistration();
+	}
 
 	// Make sure that the player spawns upright
 	GetEntity()->SetWorldTM(Matrix34::Create(Vec3(1, 1, 1), IDENTITY, GetEntity()->GetWorldPos()));
+	CSessionRecorder::RecordSpawn(GetEntityId(), GetEntity()->GetWorldPos());
 
-	// Apply character to the entity
-	m_pAnimationComponent->ResetCharacter();
+	// Apply character to the entity, a character that is still loading is applied once read
+	if (!m_isLoading)
+	{
+		m_pAnimationComponent->ResetCharacter();
+	}
 	Physicalize();
 	//m_pCharacterController->Physicalize();
 
+	// Rays of the previous life hit from where the player died
+	ResetRays();
+
 	// Reset input now that the player respawned
-	m_inputFlags = 0;
-	m_mouseDeltaRotation = ZERO;
+	m_inputRing.Clear();
 	m_mouseDeltaSmoothingFilter.Reset();
 
 	m_activeFragmentId = FRAGMENT_ID_INVALID;
 
-	m_lookOrientation = IDENTITY;
+	m_lookAngles = PlayerSimulation::SLookAngles();
+	m_previousLookAngles = PlayerSimulation::SLookAngles();
+	m_renderLookAngles = PlayerSimulation::SLookAngles();
+	// The spawn point rotated the entity and the camera component may have been reset, write everything next frame
+	m_lookCache.isValid = false;
 	m_horizontalAngularVelocity = 0.0f;
 	m_averagedHorizontalAngularVelocity.Reset();
+	m_clock.Reset();
 }
 
 void CPlayerComponent::ReviveOnCamChange()
@@ -476,97 +536,44 @@ void CPlayerComponent::ReviveOnCamChange()
 	m_pAnimationComponent->ResetCharacter();
 	m_pCharacterController->Physicalize();
 
+	// Rays of the previous life hit from where the player died
+	ResetRays();
+
 	// Reset input now that the player respawned
-	m_inputFlags = 0;
-	m_mouseDeltaRotation = ZERO;
+	m_inputRing.Clear();
 	m_mouseDeltaSmoothingFilter.Reset();
 
 	m_activeFragmentId = FRAGMENT_ID_INVALID;
 
-	//m_lookOrientation = IDENTITY;
+	//m_lookAngles = PlayerSimulation::SLookAngles();
 	//m_horizontalAngularVelocity = 0.0f;
 	//m_averagedHorizontalAngularVelocity.Reset();
 }
 
-void CPlayerComponent::Physicalize()
+void CPlayerComponent::SwitchCamera()
 {
-	m_standPhys = true;
-	m_crouchPhys = false;
-	// Physicalize the player as type Living.
-	// This physical entity type is specifically implemented for players
-	SEntityPhysicalizeParams physParams;
-	physParams.type = PE_LIVING;
+	const CTimeValue start = gEnv->pTimer->GetAsyncTime();
+	const bool bFirstPerson = !m_isFPS;
 
-	physParams.mass = 100.0f;
-	CryLog("physicalize stand");
-	pe_player_dimensions playerDimensions;
-
-	// Prefer usage of a cylinder instead of capsule
-	//if(!m_isCrouching)
-	playerDimensions.bUseCapsule = 1;
-	//else
-	//	playerDimensions.bUseCapsule = 0;
-
-	// Specify the size of our cylinder
-	playerDimensions.sizeCollider = Vec3(0.35f, 0.35f, 0.5f);
-
-	// Keep pivot at the player's feet (defined in player geometry) 
-	playerDimensions.heightPivot = 0.f;
-	// Offset collider upwards
-	playerDimensions.heightCollider = 1.f;
-	playerDimensions.groundContactEps = 0.004f;
-
-	physParams.pPlayerDimensions = &playerDimensions;
-
-	pe_player_dynamics playerDynamics;
-	playerDynamics.kAirControl = 0.f;
-	playerDynamics.mass = physParams.mass;
-	physParams.pPlayerDynamics = &playerDynamics;
-
-	GetEntity()->Physicalize(physParams);
-}
-
-void CPlayerComponent::PhysicalizeCrouch()
-{
-	m_standPhys = false;
-	m_crouchPhys = true;
-
-	CryLog("physicalize crouch");
-	SEntityPhysicalizeParams physParams;
-	physParams.type = PE_LIVING;
-
-	physParams.mass = 100.0f;
-
-	pe_player_dimensions playerDimensions;
-
-	// Prefer usage of a cylinder instead of capsule
-	//if(!m_isCrouching)
-	playerDimensions.bUseCapsule = 1;
-	//else
-	//	playerDimensions.bUseCapsule = 0;
-
-	// Specify the size of our cylinder
-	playerDimensions.sizeCollider = Vec3(0.35f, 0.35f, 0.2f);
-
-	// Keep pivot at the player's feet (defined in player geometry) 
-	playerDimensions.heightPivot = 0.f;
-	// Offset collider upwards
-	playerDimensions.heightCollider = 0.8f;
-	playerDimensions.groundContactEps = 0.004f;
-
-	physParams.pPlayerDimensions = &playerDimensions;
+	// Hide the head of the resident character, animation, Mannequin state and physics carry on untouched
+	if (!m_attachments.SetHiddenInMainPass(CPlayerAttachments::EAttachment::Head, bFirstPerson))
+	{
+		// Character without a head attachment, swap to the matching character file instead
+		ReviveOnCamChange();
+		m_attachments.Invalidate();
+		m_pAnimationComponent->SetCharacterFile(bFirstPerson ? "Objects/Characters/mixamo/pants_guy_nohead.cdf" : "Objects/Characters/mixamo/pants_guy.cdf");
+		m_pAnimationComponent->LoadFromDisk();
+		m_pAnimationComponent->ResetCharacter();
+	}
 
-	pe_player_dynamics playerDynamics;
-	playerDynamics.kAirControl = 0.f;
-	playerDynamics.mass = physParams.mass;
-	physParams.pPlayerDynamics = &playerDynamics;
+	m_isFPS = bFirstPerson;
 
-	GetEntity()->Physicalize(physParams);
+	CryLog("changing to %s person, switch took %.3f ms", m_isFPS ? "first" : "third", (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds());
 }
 
 void CPlayerComponent::PlayThrowSound()
 {
-	CryLog("grunt throw sound play");
+	CEventLog::Write(EventLog::EEvent::ThrowSound, GetEntityId());
 
 	CryAudio::SExecuteTriggerData const data("throw", CryAudio::EOcclusionType::Ignore, GetEntity()->GetWorldPos(), true, m_gruntThrow);
 	gEnv->pAudioSystem->ExecuteTriggerEx(data);
@@ -581,19 +588,22 @@ void CPlayerComponent::ShootRayFromHead()
 	else
 		pos = GetEntity()->GetPos() + Vec3(0.0f, 0.10f, 2.0f);
 
-	ray_hit hit;
 	Vec3 dir = Vec3(0.0f, 0.0f, 1.0f);// GetEntity()->GetForwardDir() * distance;
-	int objTypes = ent_all;//ent_static | ent_rigid | ent_terrain; //change to ent_all if no detection
-	//const unsigned int flags = rwi_stop_at_pierceable | rwi_colltype_any;
 
-
-	static IPhysicalEntity* pSkipEntities[10];
-	pSkipEntities[0] = playerEntity.GetPhysics();
-
-	gEnv->pPhysicalWorld->RayWorldIntersection(pos, dir, ent_static | ent_sleeping_rigid | ent_rigid | ent_independent | ent_terrain,
-		rwi_stop_at_pierceable | rwi_colltype_any, &hit, 1, pSkipEntities, 2);
-	//CryLog("distance to hit %f", hit.dist);
-	if (hit.dist < 1.0f && hit.dist > 0.0f)
+	// Headroom ray, m_canStand follows last frame's result
+	SRayRequest request;
+	request.origin = pos;
+	request.direction = dir;
+	request.objectTypes = ent_static | ent_sleeping_rigid | ent_rigid | ent_independent | ent_terrain;
+	request.pSkipEntities[0] = playerEntity.GetPhysics();
+	request.skipEntityCount = 1;
+	request.pOwner = this;
+	request.pResult = &m_headRayResult;
+	CGamePlugin::GetInstance()->GetRaycasts().Submit(std::move(request));
+
+	const SRayResult& hit = m_headRayResult;
+	//CryLog("distance to hit %f", hit.distance);
+	if (hit.distance < 1.0f && hit.distance > 0.0f)
 	{
 		m_canStand = false;
 	}
@@ -601,59 +611,54 @@ void CPlayerComponent::ShootRayFromHead()
 	{
 		m_canStand = true;
 	}
-	IPersistantDebug *pPD = gEnv->pGameFramework->GetIPersistantDebug();
-	if (pPD)
-	{
-		pPD->Begin("InteractionVector", false);
-		pPD->AddSphere(hit.pt, 0.1f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f);
-
-		//aux geometry
-		if (auto pAuxGeom = gEnv->pRenderer->GetIRenderAuxGeom())
-			//pAuxGeom->DrawSphere(Pos, radius, color);
-
-		if (m_canStand)
-			pPD->AddText(10.0f, 20.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "can stand");
-		else
-			pPD->AddText(10.0f, 20.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "can't stand");
-
-	}
+	GAME_DEBUG_DRAW(EDebugCategory::Headroom, AddSphere, hit.point, 0.1f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f);
+	GAME_DEBUG_DRAW(EDebugCategory::Headroom, AddText, 10.0f, 20.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, m_canStand ? "can stand" : "can't stand");
 }
 
 void CPlayerComponent::RayCast(Vec3 origin, Quat dir, IEntity & pSkipEntity)
 {
-	ray_hit hit;
 	float m_InterationDistance = 10.0f;
-	Vec3 finalDir = dir* Vec3(0.0f, m_InterationDistance, 0.0f);
-	int objTypes = ent_all;
-	const unsigned int flags = rwi_stop_at_pierceable | rwi_colltype_any;
-	static IPhysicalEntity* pSkipEntities[10];
-	pSkipEntities[0] = pSkipEntity.GetPhysics();
 
-	gEnv->pPhysicalWorld->RayWorldIntersection(origin, finalDir, objTypes, flags, &hit, 1, pSkipEntities, 2);
+	// Interaction probe, reports what was under the crosshair last frame
+	SRayRequest request;
+	request.origin = origin;
+	request.direction = dir * Vec3(0.0f, m_InterationDistance, 0.0f);
+	request.objectTypes = ent_all;
+	request.pSkipEntities[0] = pSkipEntity.GetPhysics();
+	request.skipEntityCount = 1;
+	request.pOwner = this;
+	request.pResult = &m_interactionRayResult;
+	CGamePlugin::GetInstance()->GetRaycasts().Submit(std::move(request));
 
-	IPersistantDebug *pPD = gEnv->pGameFramework->GetIPersistantDebug();
+	const SRayResult& hit = m_interactionRayResult;
 
-	if (hit.pCollider)
+	if (hit.bHit)
 	{
-		if (pPD)
-		{
-			pPD->Begin("Raycast", false);
-			pPD->AddSphere(hit.pt, 0.25f, ColorF(Vec3(1, 1, 0), 0.5f), 1.0f);
-		}
-		IPhysicalEntity *pHitEntity = hit.pCollider;
-		IEntity* pEntity = gEnv->pEntitySystem->GetEntityFromPhysics(pHitEntity);
+		GAME_DEBUG_DRAW(EDebugCategory::Interaction, AddSphere, hit.point, 0.25f, ColorF(Vec3(1, 1, 0), 0.5f), 1.0f);
+
+		IEntity* pEntity = gEnv->pEntitySystem->GetEntity(hit.entityId);
 		if (pEntity)
 		{
 			IEntityClass* pClass = pEntity->GetClass();
 			pClassName = pClass->GetName();
-			if (pPD)
-				pPD->AddText3D(hit.pt, 3.0f, ColorF(Vec3(1, 1, 0), 0.5f), 1.0f, pClassName);
+			GAME_DEBUG_DRAW(EDebugCategory::Interaction, AddText3D, hit.point, 3.0f, ColorF(Vec3(1, 1, 0), 0.5f), 1.0f, "%s", pClassName);
 		}
 	}
 
 }
 
 
+void CPlayerComponent::ResetRays()
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetRaycasts().Cancel(this);
+	}
+
+	m_cameraRayResult = SRayResult();
+	m_headRayResult = SRayResult();
+	m_interactionRayResult = SRayResult();
+}
 
 void CPlayerComponent::SpawnAtSpawnPoint()
 {
@@ -662,35 +667,45 @@ void CPlayerComponent::SpawnAtSpawnPoint()
 	if (gEnv->IsEditor())
 		return;
 
-	// Spawn at first default spawner
-	auto *pEntityIterator = gEnv->pEntitySystem->GetEntityIterator();
-	pEntityIterator->MoveFirst();
+	CGamePlugin* pPlugin = CGamePlugin::GetInstance();
+	if (pPlugin == nullptr)
+		return;
 
-	while (!pEntityIterator->IsEnd())
+	// Positions of everybody else, for spawning away from them
+	std::vector<Vec3> otherPlayerPositions;
+	otherPlayerPositions.reserve(pPlugin->m_players.size());
+	for (const auto& player : pPlugin->m_players)
 	{
-		IEntity *pEntity = pEntityIterator->Next();
-
-		if (auto* pSpawner = pEntity->GetComponent<CSpawnPointComponent>())
+		IEntity* pPlayerEntity = gEnv->pEntitySystem->GetEntity(player.second);
+		if (pPlayerEntity != nullptr && pPlayerEntity != m_pEntity)
 		{
-			pSpawner->SpawnEntity(m_pEntity);
-			break;
+			otherPlayerPositions.push_back(pPlayerEntity->GetWorldPos());
 		}
 	}
+
+	// Spawn at the spawner picked by g_spawnPolicy
+	if (CSpawnPointComponent* pSpawner = pPlugin->GetSpawnRegistry().Select(otherPlayerPositions))
+	{
+		pSpawner->SpawnEntity(m_pEntity);
+	}
 }
 
 void CPlayerComponent::HandleInputFlagChange(TInputFlags flags, int activationMode, EInputFlagType type)
 {
+	// Held flags go into the input frame being assembled, see PlayerInput::CRing
+	TInputFlags inputFlags = m_inputRing.GetFlags();
+
 	switch (type)
 	{
 	case EInputFlagType::Hold:
 	{
 		if (activationMode == eIS_Released)
 		{
-			m_inputFlags &= ~flags;
+			inputFlags &= ~flags;
 		}
 		else
 		{
-			m_inputFlags |= flags;
+			inputFlags |= flags;
 		}
 	}
 	break;
@@ -699,9 +714,34 @@ void CPlayerComponent::HandleInputFlagChange(TInputFlags flags, int activationMo
 		if (activationMode == eIS_Released)
 		{
 			// Toggle the bit(s)
-			m_inputFlags ^= flags;
+			inputFlags ^= flags;
 		}
 	}
 	break;
 	}
+
+	m_inputRing.SetFlags(inputFlags);
+}
+
+void CPlayerComponent::Deactivate()
+{
+	m_isPooled = true;
+
+	// Pending rays write into our members, batched updates would keep simulating the player
+	ResetRays();
+	UpdateRegistration();
+
+	GetEntity()->Hide(true);
+	if (pTorchEntity != nullptr)
+		pTorchEntity->Hide(true);
+	if (pFlashlightEntity != nullptr)
+		pFlashlightEntity->Hide(true);
+
+	// Remove the living entity, Revive physicalizes the player again
+	SEntityPhysicalizeParams physParams;
+	physParams.type = PE_NONE;
+	GetEntity()->Physicalize(physParams);
+
+	m_inputRing.Clear();
+	ResetNetworking();
 }
\ No newline at end of file
@@ -1,13 +1,14 @@
 #pragma once
 
 #include <array>
-#include <numeric>
 
 #include <CryEntitySystem/IEntityComponent.h>
 #include <CryMath/Cry_Camera.h>
 
 #include <ICryMannequin.h>
 
+#include <CryNetwork/Rmi.h>
+
 #include <DefaultComponents/Cameras/CameraComponent.h>
 #include <DefaultComponents/Physics/CharacterControllerComponent.h>
 #include <DefaultComponents/Geometry/AdvancedAnimationComponent.h>
@@ -15,25 +16,19 @@
 
 #include "../Attachments/Torch.h"
 #include "../Attachments/Flashlight.h"
+#include "../Systems/AnimEventDispatcher.h"
+#include "../Systems/MovementPrediction.h"
+#include "../Systems/RaycastService.h"
+#include "../Systems/SimulationClock.h"
+#include "PlayerAttachments.h"
+#include "PlayerInputFilter.h"
+#include "PlayerInputRing.h"
+#include "PlayerSimulation.h"
+#include "PlayerStateMachine.h"
 
 ////////////////////////////////////////////////////////
 // Represents a player participating in gameplay
 ////////////////////////////////////////////////////////
-enum EPlayerState
-{
-	ePS_None,
-	ePS_Standing,
-	ePS_MovingToStanding,
-	ePS_Crouching,
-	ePS_MovingToCrouching,
-	ePS_Jumping,
-	ePS_WeaponMove,
-	ePS_WeaponIdle,
-	ePS_Interuptable,
-	ePS_Last
-};
-
-
 class CPlayerComponent final : public IEntityComponent
 {
 	enum class EInputFlagType
@@ -42,73 +37,12 @@ class CPlayerComponent final : public IEntityComponent
 		Toggle
 	};
 
-	typedef uint8 TInputFlags;
-
-	enum class EInputFlag
-		: TInputFlags
-	{
-		MoveLeft = 1 << 0,
-		MoveRight = 1 << 1,
-		MoveForward = 1 << 2,
-		MoveBack = 1 << 3,
-		Crouch = 1 << 4,
-		WeaponDrawn = 1 << 5
-	};
-
-	template<typename T, size_t SAMPLES_COUNT>
-	class MovingAverage
-	{
-		static_assert(SAMPLES_COUNT > 0, "SAMPLES_COUNT shall be larger than zero!");
-
-	public:
-
-		MovingAverage()
-			: m_values()
-			, m_cursor(SAMPLES_COUNT)
-			, m_accumulator()
-		{
-		}
-
-		MovingAverage& Push(const T& value)
-		{
-			if (m_cursor == SAMPLES_COUNT)
-			{
-				m_values.fill(value);
-				m_cursor = 0;
-				m_accumulator = std::accumulate(m_values.begin(), m_values.end(), T(0));
-			}
-			else
-			{
-				m_accumulator -= m_values[m_cursor];
-				m_values[m_cursor] = value;
-				m_accumulator += m_values[m_cursor];
-				m_cursor = (m_cursor + 1) % SAMPLES_COUNT;
-			}
-
-			return *this;
-		}
-
-		T Get() const
-		{
-			return m_accumulator / T(SAMPLES_COUNT);
-		}
-
-		void Reset()
-		{
-			m_cursor = SAMPLES_COUNT;
-		}
-
-	private:
-
-		std::array<T, SAMPLES_COUNT> m_values;
-		size_t m_cursor;
-
-		T m_accumulator;
-	};
+	typedef PlayerSimulation::TInputFlags TInputFlags;
+	typedef PlayerSimulation::EInputFlag EInputFlag;
 
 public:
 	CPlayerComponent() = default;
-	virtual ~CPlayerComponent() {}
+	virtual ~CPlayerComponent();
 
 	// IEntityComponent
 	virtual void Initialize() override;
@@ -124,10 +58,17 @@ public:
 	}
 
 	void Revive();
+	// Hides the player and stops updating it until the next Revive, see CPlayerPool
+	void Deactivate();
 	void ReviveOnCamChange();
+	// Toggles first and third person, hides the head in first person
+	void SwitchCamera();
 
+	// Rebuilds the living entity with the standing collider
 	void Physicalize();
-	void PhysicalizeCrouch();
+	// Applies m_desiredCollider to the existing living entity, at most once per swap interval
+	void UpdateCollider(float frameTime);
+	static void LogColliderStatistics(IConsoleCmdArgs* pArgs);
 
 	void PlayThrowSound();
 	//raycasting
@@ -135,23 +76,120 @@ public:
 	void RayCast(Vec3 origin, Quat dir, IEntity & pSkipEntity);
 
 	void InitializeInput();
-	void InitializeUpdate(EPlayerState state, float frameTime);
-	void InitializeMovement(float frameTime);
 	void InitializeAttachements();
 
+	// False while waiting in the player pool or while the character streams in
+	bool IsControllable() const { return !m_isPooled && !m_isLoading; }
+
+	// Input commands of the last frames, sent by the owning client every frame
+	struct SInputPacket
+	{
+		uint32 count = 0;
+		MovementPrediction::SInputCommand commands[CMovementPredictor::RedundantCommands];
+		// Mouse filter of the client as a PlayerInput::EFilter and its parameters, the server smooths the look deltas the same way
+		uint8 lookFilter = 0;
+		float lookFilterTimeConstant = 0.f;
+		float lookFilterMinCutoff = 0.f;
+		float lookFilterBeta = 0.f;
+
+		void SerializeWith(TSerialize ser)
+		{
+			ser.Value("lookFilter", lookFilter);
+			ser.Value("lookFilterTimeConstant", lookFilterTimeConstant);
+			ser.Value("lookFilterMinCutoff", lookFilterMinCutoff);
+			ser.Value("lookFilterBeta", lookFilterBeta);
+			ser.Value("count", count);
+			count = min(count, CMovementPredictor::RedundantCommands);
+			for (uint32 i = 0; i < count; ++i)
+			{
+				ser.BeginGroup("command");
+				commands[i].SerializeWith(ser);
+				ser.EndGroup();
+			}
+		}
+	};
+
+	// Authoritative state after the last applied command, sent by the server to the owning client every frame
+	struct SStatePacket
+	{
+		uint32 ackSequence = 0;
+		Vec3 position = ZERO;
+		float lookYaw = 0.f;
+		float lookPitch = 0.f;
+		uint8 state = ePS_Standing;
+		uint8 conditions = 0;
+
+		void SerializeWith(TSerialize ser)
+		{
+			ser.Value("ackSequence", ackSequence);
+			ser.Value("position", position);
+			ser.Value("lookYaw", lookYaw);
+			ser.Value("lookPitch", lookPitch);
+			ser.Value("state", state);
+			ser.Value("conditions", conditions);
+		}
+	};
+
+	// Remote method invocations of client-side prediction, see g_netPrediction
+	bool ServerInput(SInputPacket&& packet, INetChannel* pNetChannel);
+	bool ClientCorrection(SStatePacket&& packet, INetChannel* pNetChannel);
+
+	// Copies the hot simulation state into a batch entry before PlayerSimulation::SimulateRange
+	void GatherSimulation(PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime);
+	// Applies the simulated entry of a fixed step to movement, look, state and networking
+	void ApplySimulation(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime);
+	// Animation, entity rotation and camera once per rendered frame, alpha between the last two steps, see CSimulationClock
+	void UpdateFrame(float frameTime, float alpha);
+
 protected:
-	void UpdateMovementRequest(float frameTime);
-	void UpdateLookDirectionRequest(float frameTime);
+	// Loads the character and Mannequin data and resolves fragment and tag ids, after streaming when g_playerStreamedLoad is set
+	void LoadCharacter();
+	// Adds the player to the player update system while it is controllable, removes it otherwise
+	void UpdateRegistration();
+
+	void InitializeNetworking();
+	void ResetNetworking();
+	// Client owning the player, moves it locally and sends its input to the server
+	bool IsPredicting() const;
+	// Player of another client on the server, moved by the input that client sends
+	bool IsRemotelyControlled() const;
+	// Takes the input of the received commands that fall into this step
+	void ConsumeRemoteCommands(float stepTime);
+	// Feeds a received command into the input ring and takes its time off the step time not covered yet
+	void ApplyRemoteCommand(const MovementPrediction::SInputCommand& command);
+	// Sends this frame's input to the server or the authoritative state to the owning client
+	void UpdateNetworking(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float frameTime);
+	MovementPrediction::SMovementState GetMovementState() const;
+
+	void UpdateMovementRequest(const PlayerSimulation::SPlayerBatch& batch, uint32 index);
+	void UpdateLookDirectionRequest(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime);
+	// Derives m_lookCache from m_renderLookAngles, see SLookCache
+	void UpdateLookCache();
+	void UpdateFlashlight();
+	void UpdateState(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float frameTime);
 	void UpdateAnimation(float frameTime);
 	void UpdateCamera(float frameTime);
 
 	void SpawnAtSpawnPoint();
+	// Cancels the pending rays and forgets their last results, for a player that leaves or respawns
+	void ResetRays();
 
 	void CreateWeapon(const char *name);
 
 	void HandleInputFlagChange(TInputFlags flags, int activationMode, EInputFlagType type = EInputFlagType::Hold);
+	void HandleInputEvent(PlayerInput::EEvent event, int activationMode);
+	// Shoots, throws and toggles as requested by the input frame of this tick
+	void ProcessInputEvents(const PlayerInput::SFrame& input);
+
+	// Anim event handlers, see s_animEvents
+	void OnThrowAnimEvent(const AnimEventInstance& event);
+	void OnThrowEndAnimEvent(const AnimEventInstance& event);
 
 protected:
+	static const CAnimEventDispatcher<CPlayerComponent> s_animEvents;
+	// Commands received ahead of the server step, beyond that the oldest is applied right away to keep the input delay bounded
+	static const uint32 MaxQueuedCommands = 8;
+
 	Cry::DefaultComponents::CCameraComponent* m_pCameraComponent = nullptr;
 	Cry::DefaultComponents::CCharacterControllerComponent* m_pCharacterController = nullptr;
 	Cry::DefaultComponents::CAdvancedAnimationComponent* m_pAnimationComponent = nullptr;
@@ -166,23 +204,61 @@ protected:
 	FragmentID m_stoneThrowId;
 	TagID m_rotateTagId;
 
-	TInputFlags m_inputFlags;
-	Vec2 m_mouseDeltaRotation;
-	MovingAverage<Vec2, 10> m_mouseDeltaSmoothingFilter;
+	// Only source of input for the simulation, the session recorder and the network send
+	PlayerInput::CRing m_inputRing;
+	// Filter picked in g_mouseFilter, or by the owning client for players of other clients
+	PlayerInput::CLookFilter m_mouseDeltaSmoothingFilter;
 
 	FragmentID m_activeFragmentId;
 	FragmentID m_desiredFragmentId;
 
 	EPlayerState m_State;
-	Quat m_lookOrientation; //!< Should translate to head orientation in the future
+	PlayerSimulation::SLookAngles m_lookAngles; //!< Should translate to head orientation in the future
+	// Look of the step before, and the one in between shown by the rendered frame
+	PlayerSimulation::SLookAngles m_previousLookAngles;
+	PlayerSimulation::SLookAngles m_renderLookAngles;
+
+	// Engine orientations derived from m_renderLookAngles, rebuilt once per frame and only for the angles that changed
+	struct SLookCache
+	{
+		PlayerSimulation::SLookAngles angles;
+		// Yaw only, the entity rotation
+		Quat bodyOrientation = IDENTITY;
+		// Pitch only, the camera rotation relative to the entity and the flashlight pitch
+		Matrix33 cameraRotation = IDENTITY;
+		Quat flashlightOrientation = IDENTITY;
+		// Both, the interaction ray
+		Quat lookOrientation = IDENTITY;
+
+		// Set for the frame in which they changed, the entity and the camera are only written then
+		bool isYawChanged = true;
+		bool isPitchChanged = true;
+		// Cleared to force a rebuild, e.g. after the entity was moved by a respawn
+		bool isValid = false;
+	};
+	SLookCache m_lookCache;
+	// Camera offset written last, the camera transform is only written again when it or the pitch changes
+	Vec3 m_cameraOffset = ZERO;
+	// The flashlight orientation matches the cache while the flashlight stays on
+	bool m_isFlashlightOriented = false;
 	float m_horizontalAngularVelocity;
-	MovingAverage<float, 10> m_averagedHorizontalAngularVelocity;
+	PlayerInput::CBoxFilter<float, 10> m_averagedHorizontalAngularVelocity;
 
 	bool m_isFPS = false;
+	// Waiting hidden in CPlayerPool for a client
+	bool m_isPooled = false;
+	// Character and Mannequin files are streaming in, see CCharacterStreamer
+	bool m_isLoading = false;
+	bool m_isStreamedLoad = false;
+	// Spawn or pool exit, reported once the first controllable frame has been applied
+	CTimeValue m_spawnTime;
+	bool m_isControllableReported = false;
 	bool m_crouchPress;
 	bool m_moving;
-	bool m_standPhys;
-	bool m_crouchPhys;
+	PlayerStateMachine::ECollider m_collider = PlayerStateMachine::ECollider::Keep;
+	PlayerStateMachine::ECollider m_desiredCollider = PlayerStateMachine::ECollider::Keep;
+	// Seconds since the last collider swap
+	float m_colliderSwapTimer = 0.f;
 	bool m_canStand;
 	bool m_isWeaponDrawn;
 	// Offset the player along the forward axis (normally back)
@@ -191,11 +267,37 @@ protected:
 	float viewOffsetUp = 2.f;
 	const char* pClassName = "";
 
+	// Results of the rays submitted last frame, written by the raycast service
+	SRayResult m_cameraRayResult;
+	SRayResult m_headRayResult;
+	SRayResult m_interactionRayResult;
+
 	bool m_throwAnim;
 	CryAudio::ControlId m_gruntThrow;
 
-	CTorchComponent* pTorch;
-	IEntity* pTorchEntity;
-	CFlashlightComponent* pFlashlight;
-	IEntity* pFlashlightEntity;
+	// Commands sent to the server and not acknowledged yet, on the owning client
+	CMovementPredictor m_predictor;
+	// Commands received from the owning client and not applied yet, on the server
+	CMovementAuthority m_authority;
+	// Ring of MaxQueuedCommands, the oldest at m_firstRemoteCommand
+	std::array<MovementPrediction::SInputCommand, MaxQueuedCommands> m_remoteCommands;
+	uint32 m_firstRemoteCommand = 0;
+	uint32 m_remoteCommandCount = 0;
+	// Server step time not covered by applied commands yet
+	float m_remoteCommandTime = 0.f;
+	// Mouse filter settings of the owning client, received with its commands
+	SGameSettings m_remoteLookSettings;
+	uint32 m_appliedSequence = 0;
+
+	// Simulation entry and fixed steps of the player while it updates itself, see g_playerBatchUpdate
+	PlayerSimulation::SPlayerBatch m_simulation;
+	CSimulationClock m_clock;
+
+	// Weapon, stone, torch and flashlight attachments of the current character
+	CPlayerAttachments m_attachments;
+
+	CTorchComponent* pTorch = nullptr;
+	IEntity* pTorchEntity = nullptr;
+	CFlashlightComponent* pFlashlight = nullptr;
+	IEntity* pFlashlightEntity = nullptr;
 };
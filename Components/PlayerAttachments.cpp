@@ -0,0 +1,100 @@
+#include "StdAfx.h"
+#include "PlayerAttachments.h"
+
+#include <CrySystem/IConsole.h>
+
+namespace
+{
+	const char* const szAttachmentNames[] = { "weapon", "stone", "torch", "flashlight", "head" };
+	static_assert(CRY_ARRAY_COUNT(szAttachmentNames) == (int)CPlayerAttachments::EAttachment::Count, "Attachment names don't match EAttachment");
+}
+
+CPlayerAttachments::SStatistics CPlayerAttachments::s_statistics;
+
+void CPlayerAttachments::Update(ICharacterInstance* pCharacter)
+{
+	static ICVar* pCacheEnabled = gEnv->pConsole->GetCVar("g_playerAttachmentCache");
+	const bool bCacheEnabled = pCacheEnabled == nullptr || pCacheEnabled->GetIVal() != 0;
+
+	if (pCharacter != m_pCharacter || bCacheEnabled != m_bCacheEnabled)
+	{
+		Invalidate();
+		m_pCharacter = pCharacter;
+		m_bCacheEnabled = bCacheEnabled;
+	}
+
+	++s_statistics.playerFrames;
+}
+
+void CPlayerAttachments::Invalidate()
+{
+	m_pCharacter = nullptr;
+
+	for (int i = 0; i < (int)EAttachment::Count; ++i)
+	{
+		m_handles[i] = nullptr;
+		m_visibility[i] = EVisibility::Unknown;
+	}
+}
+
+IAttachment* CPlayerAttachments::Get(EAttachment attachment)
+{
+	if (!m_bCacheEnabled)
+		return Resolve(attachment);
+
+	IAttachment*& pHandle = m_handles[(int)attachment];
+	if (pHandle == nullptr)
+	{
+		pHandle = Resolve(attachment);
+	}
+
+	return pHandle;
+}
+
+void CPlayerAttachments::SetVisible(EAttachment attachment, bool bVisible)
+{
+	const EVisibility visibility = bVisible ? EVisibility::Visible : EVisibility::Hidden;
+	if (m_bCacheEnabled && m_visibility[(int)attachment] == visibility)
+		return;
+
+	if (IAttachment* pAttachment = Get(attachment))
+	{
+		pAttachment->HideAttachment(bVisible ? 0 : 1);
+		++s_statistics.managerCalls;
+
+		m_visibility[(int)attachment] = visibility;
+	}
+}
+
+bool CPlayerAttachments::SetHiddenInMainPass(EAttachment attachment, bool bHidden)
+{
+	IAttachment* pAttachment = Get(attachment);
+	if (pAttachment == nullptr)
+		return false;
+
+	const uint32 flags = pAttachment->GetFlags();
+	pAttachment->SetFlags(bHidden ? flags | FLAGS_ATTACH_HIDE_MAIN_PASS : flags & ~FLAGS_ATTACH_HIDE_MAIN_PASS);
+	++s_statistics.managerCalls;
+
+	return true;
+}
+
+void CPlayerAttachments::LogStatistics(IConsoleCmdArgs* pArgs)
+{
+	const float callsPerPlayerFrame = s_statistics.playerFrames > 0 ? (float)s_statistics.managerCalls / s_statistics.playerFrames : 0.f;
+
+	CryLogAlways("Player attachments: %u attachment manager calls over %u player frames, %.3f calls per player per frame",
+		s_statistics.managerCalls, s_statistics.playerFrames, callsPerPlayerFrame);
+
+	// Start a new measurement, e.g. after toggling g_playerAttachmentCache
+	s_statistics = SStatistics();
+}
+
+IAttachment* CPlayerAttachments::Resolve(EAttachment attachment)
+{
+	if (m_pCharacter == nullptr)
+		return nullptr;
+
+	++s_statistics.managerCalls;
+	return m_pCharacter->GetIAttachmentManager()->GetInterfaceByName(szAttachmentNames[(int)attachment]);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <CryAnimation/ICryAnimation.h>
+
+////////////////////////////////////////////////////////
+// Attachment handles of a player character, resolved by name once per character instance
+// Visibility is only pushed to the attachment when the requested state differs from the last one applied
+////////////////////////////////////////////////////////
+class CPlayerAttachments
+{
+public:
+	enum class EAttachment
+	{
+		Weapon = 0,
+		Stone,
+		Torch,
+		Flashlight,
+		Head,
+		Count
+	};
+
+	// Shared by all players, see g_playerAttachmentStats
+	struct SStatistics
+	{
+		// GetInterfaceByName, HideAttachment and SetFlags calls
+		uint32 managerCalls = 0;
+		uint32 playerFrames = 0;
+	};
+
+public:
+	// Called once per frame, resolves the handles again if the character instance was swapped
+	void Update(ICharacterInstance* pCharacter);
+	// Drops the handles, e.g. before the character file is reloaded
+	void Invalidate();
+
+	IAttachment* Get(EAttachment attachment);
+	void SetVisible(EAttachment attachment, bool bVisible);
+	// Hides the attachment from the camera while it keeps casting shadows, returns false if the character has no such attachment
+	bool SetHiddenInMainPass(EAttachment attachment, bool bHidden);
+
+	static SStatistics& GetStatistics() { return s_statistics; }
+	static void LogStatistics(IConsoleCmdArgs* pArgs);
+
+protected:
+	enum class EVisibility : uint8
+	{
+		Unknown,
+		Hidden,
+		Visible
+	};
+
+	IAttachment* Resolve(EAttachment attachment);
+
+protected:
+	ICharacterInstance* m_pCharacter = nullptr;
+	IAttachment* m_handles[(int)EAttachment::Count] = {};
+	EVisibility m_visibility[(int)EAttachment::Count] = {};
+
+	// g_playerAttachmentCache, sampled in Update
+	bool m_bCacheEnabled = true;
+
+	static SStatistics s_statistics;
+};
@@ -1,4 +1,6 @@
 #include "Player.h"
+#include "../GamePlugin.h"
+#include <CrySystem/IConsole.h>
 #include <DefaultComponents/Input/InputComponent.h>
 
 void CPlayerComponent::InitializeInput()
@@ -25,130 +27,165 @@ void CPlayerComponent::InitializeInput()
 	m_pInputComponent->RegisterAction("player", "weapondrawn", [this](int activationMode, float value) { HandleInputFlagChange((TInputFlags)EInputFlag::WeaponDrawn, activationMode);  });
 	m_pInputComponent->BindAction("player", "weapondrawn", eAID_KeyboardMouse, EKeyId::eKI_Mouse2);
 
-	m_pInputComponent->RegisterAction("player", "mouse_rotateyaw", [this](int activationMode, float value) { m_mouseDeltaRotation.x -= value; });
+	m_pInputComponent->RegisterAction("player", "mouse_rotateyaw", [this](int activationMode, float value) { m_inputRing.AddLookDelta(Vec2(-value, 0.f)); });
 	m_pInputComponent->BindAction("player", "mouse_rotateyaw", eAID_KeyboardMouse, EKeyId::eKI_MouseX);
 
-	m_pInputComponent->RegisterAction("player", "mouse_rotatepitch", [this](int activationMode, float value) { m_mouseDeltaRotation.y -= value; });
+	m_pInputComponent->RegisterAction("player", "mouse_rotatepitch", [this](int activationMode, float value) { m_inputRing.AddLookDelta(Vec2(0.f, -value)); });
 	m_pInputComponent->BindAction("player", "mouse_rotatepitch", eAID_KeyboardMouse, EKeyId::eKI_MouseY);
 
-	// Register the shoot action
-	m_pInputComponent->RegisterAction("player", "camswitch", [this](int activationMode, float value)
-	{
-		// Only fire on press, not release
-		if (activationMode == eIS_Pressed)
-		{
-			if (m_isFPS)
-			{
-				CryLog("changing to fps %d", m_isFPS);
-				ReviveOnCamChange();
-				m_pAnimationComponent->SetCharacterFile("Objects/Characters/mixamo/pants_guy.cdf");
-				m_pAnimationComponent->LoadFromDisk();
-				m_pAnimationComponent->ResetCharacter();
-
-				m_isFPS = false;
-			}
-			else
-			{
-				CryLog("changing to 3rd  person %i", m_isFPS);
-				ReviveOnCamChange();
-				m_pAnimationComponent->SetCharacterFile("Objects/Characters/mixamo/pants_guy_nohead.cdf");
-				m_pAnimationComponent->LoadFromDisk();
-				m_pAnimationComponent->ResetCharacter();
-				m_isFPS = true;
-			}
-		}
-	});
-
-	// Bind the shoot action to left mouse click
+	// One-shot actions are only recorded here and handled by ProcessInputEvents in the tick that commits them
+	// Only fire on press, not release
+	m_pInputComponent->RegisterAction("player", "camswitch", [this](int activationMode, float value) { HandleInputEvent(PlayerInput::EEvent::CameraSwitch, activationMode); });
+	// Bind the camera switch action to tab
 	m_pInputComponent->BindAction("player", "camswitch", eAID_KeyboardMouse, EKeyId::eKI_Tab);
 
 	//turn on/off the torch
-	m_pInputComponent->RegisterAction("player", "torchOn", [this](int activationMode, float value)
-	{
-		if (activationMode == eIS_Pressed)
-		{
-			if (!pTorch->IsEnabled())
-			{
-				pTorch->Enable(true);
-				CryLog("turn on torch");
-			}
-			else
-			{
-				pTorch->Enable(false);
-				CryLog("turn off torch");
-			}
-		}
-	});
+	m_pInputComponent->RegisterAction("player", "torchOn", [this](int activationMode, float value) { HandleInputEvent(PlayerInput::EEvent::Torch, activationMode); });
 	// Bind the torch turn on/off action to T
 	m_pInputComponent->BindAction("player", "torchOn", eAID_KeyboardMouse, EKeyId::eKI_T);
 
 	//flashlight 
 	//turn on/off the flashlight
-	m_pInputComponent->RegisterAction("player", "flashlightOn", [this](int activationMode, float value)
+	m_pInputComponent->RegisterAction("player", "flashlightOn", [this](int activationMode, float value) { HandleInputEvent(PlayerInput::EEvent::Flashlight, activationMode); });
+	// Bind the flashlight turn on/off action to F
+	m_pInputComponent->BindAction("player", "flashlightOn", eAID_KeyboardMouse, EKeyId::eKI_F);
+
+	// Register the shoot action
+	m_pInputComponent->RegisterAction("player", "shoot", [this](int activationMode, float value) { HandleInputEvent(PlayerInput::EEvent::Shoot, activationMode); });
+	// Bind the shoot action to left mouse click
+	m_pInputComponent->BindAction("player", "shoot", eAID_KeyboardMouse, EKeyId::eKI_Mouse1);
+
+	m_pInputComponent->RegisterAction("player", "StoneThrow", [this](int activationMode, float value) { HandleInputEvent(PlayerInput::EEvent::Throw, activationMode); });
+	m_pInputComponent->BindAction("player", "StoneThrow", eAID_KeyboardMouse, EKeyId::eKI_G);
+
+}
+
+void CPlayerComponent::HandleInputEvent(PlayerInput::EEvent event, int activationMode)
+{
+	if (activationMode == eIS_Pressed)
+	{
+		m_inputRing.AddEvent(event);
+	}
+}
+
+void CPlayerComponent::ProcessInputEvents(const PlayerInput::SFrame& input)
+{
+	// The character can't be swapped while it is still loading
+	if (input.HasEvent(PlayerInput::EEvent::CameraSwitch) && !m_isLoading)
+	{
+		SwitchCamera();
+	}
+
+	if (input.HasEvent(PlayerInput::EEvent::Torch) && pTorch != nullptr)
 	{
-		if (activationMode == eIS_Pressed)
+		if (!pTorch->IsEnabled())
 		{
-			if (!pFlashlight->IsEnabled())
-			{
-				pFlashlight->Enable(true);
-				CryLog("turn on flashlight");
-			}
-			else
-			{
-				pFlashlight->Enable(false);
-				CryLog("turn off flashlight");
-			}
+			pTorch->Enable(true);
+			CryLog("turn on torch");
 		}
-	});
-	// Bind the torch turn on/off action to T
-	m_pInputComponent->BindAction("player", "flashlightOn", eAID_KeyboardMouse, EKeyId::eKI_F);
-
+		else
+		{
+			pTorch->Enable(false);
+			CryLog("turn off torch");
+		}
+	}
 
-	// Register the shoot action
-	m_pInputComponent->RegisterAction("player", "shoot", [this](int activationMode, float value)
+	if (input.HasEvent(PlayerInput::EEvent::Flashlight) && pFlashlight != nullptr)
 	{
-		// Only fire on press, not release
-		if (activationMode == eIS_Pressed && m_isWeaponDrawn == true)
+		if (!pFlashlight->IsEnabled())
 		{
-			if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
-			{
-				auto *pBarrelOutAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("weapon");
+			pFlashlight->Enable(true);
+			CryLog("turn on flashlight");
+		}
+		else
+		{
+			pFlashlight->Enable(false);
+			CryLog("turn off flashlight");
+		}
+	}
 
-				if (pBarrelOutAttachment != nullptr)
-				{
-					QuatTS bulletOrigin = pBarrelOutAttachment->GetAttWorldAbsolute();
+	if (input.HasEvent(PlayerInput::EEvent::Shoot) && m_isWeaponDrawn == true)
+	{
+		IAttachment* pBarrelOutAttachment = m_attachments.Get(CPlayerAttachments::EAttachment::Weapon);
 
-					SEntitySpawnParams spawnParams;
-					spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+		if (pBarrelOutAttachment != nullptr)
+		{
+			QuatTS bulletOrigin = pBarrelOutAttachment->GetAttWorldAbsolute();
 
-					spawnParams.vPosition = bulletOrigin.t;
-					spawnParams.qRotation = bulletOrigin.q;
+			const float bulletScale = 0.05f;
+			bulletOrigin.s = bulletScale;
 
-					const float bulletScale = 0.05f;
-					spawnParams.vScale = Vec3(bulletScale);
+			// Bullet is propelled in the rotation it was launched with, backwards along the barrel's forward axis
+			const float initialVelocity = -CUserSettings::Get().bulletVelocity;
+			const Vec3 velocity = bulletOrigin.q.GetColumn1() * initialVelocity;
 
-					// Spawn the entity
-					if (IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
-					{
-						// See Bullet.cpp, bullet is propelled in  the rotation and position the entity was spawned with
-						pEntity->CreateComponentClass<CBulletComponent>();
-					}
-				}
+			// Take a bullet from the pool or the ballistics system, see CGamePlugin::LaunchProjectile
+			if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+			{
+				pPlugin->LaunchProjectile(Projectile::EType::Bullet, bulletOrigin, velocity, GetEntityId());
 			}
 		}
-	});
+	}
 
-	// Bind the shoot action to left mouse click
-	m_pInputComponent->BindAction("player", "shoot", eAID_KeyboardMouse, EKeyId::eKI_Mouse1);
+	if (input.HasEvent(PlayerInput::EEvent::Throw))
+	{
+		m_State = ePS_Interuptable;
+		m_throwAnim = true;
+	}
+}
+
+void PlayerInput::MeasureFilterDelay(IConsoleCmdArgs* pArgs)
+{
+	const float delta = pArgs->GetArgCount() > 1 ? (float)atof(pArgs->GetArg(1)) : 10.f;
+	if (delta <= 0.f)
+	{
+		CryLogAlways("Usage: g_mouseFilterDelay [mouse delta per step = 10]");
+		return;
+	}
 
-	m_pInputComponent->RegisterAction("player", "StoneThrow", [this](int activationMode, float value)
+	// Filters run once per fixed player step, see CSimulationClock
+	ICVar* pTickRate = gEnv->pConsole->GetCVar("g_playerTickRate");
+	const int tickRate = pTickRate != nullptr ? pTickRate->GetIVal() : 0;
+	const float stepTime = tickRate > 0 ? 1.f / tickRate : max(gEnv->pTimer->GetFrameTime(), 0.001f);
+
+	const SGameSettings& settings = CUserSettings::Get();
+	const EFilter currentMode = static_cast<EFilter>(CLAMP(settings.mouseFilter, 0, (int)EFilter::Last - 1));
+	const char* szNames[] = { "Raw", "Box", "Exponential", "OneEuro" };
+	static_assert(CRY_ARRAY_COUNT(szNames) == (int)EFilter::Last, "Filter names don't match EFilter");
+
+	CryLogAlways("Mouse filter delay for a step of %.2f per player step at %.1f steps per second (%s)",
+		delta, 1.f / stepTime, tickRate > 0 ? "fixed" : "current fps");
+
+	const uint32 maxSteps = static_cast<uint32>(2.f / stepTime) + 1;
+	for (int i = 0; i < (int)EFilter::Last; ++i)
 	{
-		if (activationMode == eIS_Pressed)
+		CLookFilter filter;
+		SGameSettings filterSettings = settings;
+		filterSettings.mouseFilter = i;
+		ConfigureLookFilter(filter, filterSettings);
+		filter.Push(Vec2(0, 0), stepTime);
+
+		// Steps after the one the movement started in until the output reaches half and 90% of the input, the raw filter takes none
+		int halfSteps = -1, ninetySteps = -1;
+		for (int step = 0; step < (int)maxSteps && ninetySteps < 0; ++step)
 		{
-			m_State = ePS_Interuptable;
-			m_throwAnim = true;
+			const float response = filter.Push(Vec2(delta, 0), stepTime).Get().x / delta;
+			if (halfSteps < 0 && response >= 0.5f)
+				halfSteps = step;
+			if (response >= 0.9f)
+				ninetySteps = step;
 		}
-	});
-	m_pInputComponent->BindAction("player", "StoneThrow", eAID_KeyboardMouse, EKeyId::eKI_G);
 
-}
\ No newline at end of file
+		if (ninetySteps < 0)
+		{
+			CryLogAlways("  %-12s 50%% %s, 90%% not reached within 2 s%s", szNames[i],
+				halfSteps >= 0 ? string().Format("%.1f ms", halfSteps * stepTime * 1000.f).c_str() : "not reached",
+				i == (int)currentMode ? " (current)" : "");
+		}
+		else
+		{
+			CryLogAlways("  %-12s 50%% %.1f ms, 90%% %.1f ms%s", szNames[i],
+				halfSteps * stepTime * 1000.f, ninetySteps * stepTime * 1000.f, i == (int)currentMode ? " (current)" : "");
+		}
+	}
+}
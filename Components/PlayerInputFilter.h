@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <numeric>
+
+#include "PlayerSimulation.h"
+
+struct IConsoleCmdArgs;
+
+////////////////////////////////////////////////////////
+// Smoothing filters for mouse input and other per-step signals
+// All filters share the same interface, Push(value, dt) then Get(), so a filter can be picked at compile time by type
+// or at runtime per player through CSelectableFilter, see g_mouseFilter
+////////////////////////////////////////////////////////
+namespace PlayerInput
+{
+	// Append only, values of g_mouseFilter
+	enum class EFilter
+	{
+		Raw = 0,
+		Box,
+		Exponential,
+		OneEuro,
+		Last
+	};
+
+	inline float GetMagnitude(float value) { return fabs_tpl(value); }
+	inline float GetMagnitude(const Vec2& value) { return value.GetLength(); }
+
+	// Passes the last value through, no delay
+	template<typename T>
+	class CRawFilter
+	{
+	public:
+		CRawFilter& Push(const T& value, float dt) { m_value = value; return *this; }
+		T Get() const { return m_value; }
+		void Reset() { m_value = T(0); }
+
+	private:
+		T m_value = T(0);
+	};
+
+	// Mean of the last SAMPLES_COUNT values, delays by about half the window
+	template<typename T, size_t SAMPLES_COUNT>
+	class CBoxFilter
+	{
+		static_assert(SAMPLES_COUNT > 0, "SAMPLES_COUNT shall be larger than zero!");
+
+	public:
+
+		CBoxFilter()
+			: m_values()
+			, m_cursor(SAMPLES_COUNT)
+			, m_accumulator()
+		{
+		}
+
+		CBoxFilter& Push(const T& value, float dt)
+		{
+			if (m_cursor == SAMPLES_COUNT)
+			{
+				m_values.fill(value);
+				m_cursor = 0;
+				m_accumulator = std::accumulate(m_values.begin(), m_values.end(), T(0));
+			}
+			else
+			{
+				m_accumulator -= m_values[m_cursor];
+				m_values[m_cursor] = value;
+				m_accumulator += m_values[m_cursor];
+				m_cursor = (m_cursor + 1) % SAMPLES_COUNT;
+			}
+
+			return *this;
+		}
+
+		T Get() const
+		{
+			return m_accumulator / T(SAMPLES_COUNT);
+		}
+
+		void Reset()
+		{
+			m_cursor = SAMPLES_COUNT;
+		}
+
+	private:
+
+		std::array<T, SAMPLES_COUNT> m_values;
+		size_t m_cursor;
+
+		T m_accumulator;
+	};
+
+	// First order low pass with a time constant in seconds, the same smoothing at any step rate
+	template<typename T>
+	class CExponentialFilter
+	{
+	public:
+		void SetTimeConstant(float timeConstant) { m_timeConstant = max(timeConstant, 0.f); }
+
+		CExponentialFilter& Push(const T& value, float dt)
+		{
+			if (!m_hasValue || m_timeConstant <= 0.f || dt <= 0.f)
+			{
+				m_value = value;
+				m_hasValue = true;
+			}
+			else
+			{
+				const float alpha = 1.f - exp_tpl(-dt / m_timeConstant);
+				m_value += (value - m_value) * alpha;
+			}
+
+			return *this;
+		}
+
+		T Get() const { return m_value; }
+		void Reset() { m_hasValue = false; m_value = T(0); }
+
+	private:
+		float m_timeConstant = 0.03f;
+		T m_value = T(0);
+		bool m_hasValue = false;
+	};
+
+	// One euro filter (Casiez et al.), a low pass whose cutoff rises with the speed of the signal
+	// Smooths jitter of slow movement and follows fast movement with little lag
+	template<typename T>
+	class COneEuroFilter
+	{
+	public:
+		// Cutoffs in Hz, beta in Hz per unit of signal change per second
+		void SetParameters(float minCutoff, float beta, float derivativeCutoff = 1.f)
+		{
+			m_minCutoff = max(minCutoff, 0.01f);
+			m_beta = max(beta, 0.f);
+			m_derivativeCutoff = max(derivativeCutoff, 0.01f);
+		}
+
+		COneEuroFilter& Push(const T& value, float dt)
+		{
+			if (!m_hasValue || dt <= 0.f)
+			{
+				m_value = value;
+				m_derivative = T(0);
+				m_hasValue = true;
+				return *this;
+			}
+
+			m_derivative += ((value - m_value) / dt - m_derivative) * GetAlpha(m_derivativeCutoff, dt);
+
+			const float cutoff = m_minCutoff + m_beta * GetMagnitude(m_derivative);
+			m_value += (value - m_value) * GetAlpha(cutoff, dt);
+
+			return *this;
+		}
+
+		T Get() const { return m_value; }
+		void Reset() { m_hasValue = false; m_value = m_derivative = T(0); }
+
+	private:
+		static float GetAlpha(float cutoff, float dt)
+		{
+			const float tau = 1.f / (gf_PI2 * cutoff);
+			return 1.f / (1.f + tau / dt);
+		}
+
+	private:
+		float m_minCutoff = 1.f;
+		float m_beta = 0.01f;
+		float m_derivativeCutoff = 1.f;
+		T m_value = T(0);
+		T m_derivative = T(0);
+		bool m_hasValue = false;
+	};
+
+	// Holds one filter of each kind and forwards to the selected one, switching resets the newly selected filter
+	template<typename T, size_t BOX_SAMPLES_COUNT = 10>
+	class CSelectableFilter
+	{
+	public:
+		void SetMode(EFilter mode)
+		{
+			if (mode == m_mode)
+				return;
+
+			m_mode = mode;
+			Reset();
+		}
+		EFilter GetMode() const { return m_mode; }
+
+		void SetParameters(float timeConstant, float minCutoff, float beta)
+		{
+			m_exponential.SetTimeConstant(timeConstant);
+			m_oneEuro.SetParameters(minCutoff, beta);
+		}
+
+		CSelectableFilter& Push(const T& value, float dt)
+		{
+			switch (m_mode)
+			{
+			case EFilter::Raw: m_raw.Push(value, dt); break;
+			case EFilter::Box: m_box.Push(value, dt); break;
+			case EFilter::Exponential: m_exponential.Push(value, dt); break;
+			case EFilter::OneEuro: m_oneEuro.Push(value, dt); break;
+			default: break;
+			}
+
+			return *this;
+		}
+
+		T Get() const
+		{
+			switch (m_mode)
+			{
+			case EFilter::Box: return m_box.Get();
+			case EFilter::Exponential: return m_exponential.Get();
+			case EFilter::OneEuro: return m_oneEuro.Get();
+			default: return m_raw.Get();
+			}
+		}
+
+		void Reset()
+		{
+			m_raw.Reset();
+			m_box.Reset();
+			m_exponential.Reset();
+			m_oneEuro.Reset();
+		}
+
+	private:
+		EFilter m_mode = EFilter::Box;
+		CRawFilter<T> m_raw;
+		CBoxFilter<T, BOX_SAMPLES_COUNT> m_box;
+		CExponentialFilter<T> m_exponential;
+		COneEuroFilter<T> m_oneEuro;
+	};
+
+	typedef CSelectableFilter<Vec2> CLookFilter;
+
+	// Applies g_mouseFilter and its parameters, keeps the filter state unless the mode changed
+	inline void ConfigureLookFilter(CLookFilter& filter, const SGameSettings& settings)
+	{
+		filter.SetMode(static_cast<EFilter>(CLAMP(settings.mouseFilter, 0, (int)EFilter::Last - 1)));
+		filter.SetParameters(settings.mouseFilterTimeConstant, settings.mouseFilterMinCutoff, settings.mouseFilterBeta);
+	}
+
+	// Feeds a step of mouse movement through every filter at the current step rate and logs how long each takes to follow
+	// Usage: g_mouseFilterDelay [mouse delta per step = 10]
+	void MeasureFilterDelay(IConsoleCmdArgs* pArgs);
+}
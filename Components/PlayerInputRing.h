@@ -0,0 +1,107 @@
+#pragma once
+
+#include "PlayerSimulation.h"
+
+////////////////////////////////////////////////////////
+// Input of a player, one frame per simulation tick in a fixed ring
+// Input callbacks only write into the frame being assembled, the tick commits it and the simulation
+// and the network send both read the committed frames, never the callbacks' state
+////////////////////////////////////////////////////////
+namespace PlayerInput
+{
+	// One-shot actions, set for the tick in which they were pressed
+	enum class EEvent : uint8
+	{
+		Shoot = 1 << 0,
+		Throw = 1 << 1,
+		CameraSwitch = 1 << 2,
+		Torch = 1 << 3,
+		Flashlight = 1 << 4
+	};
+
+	// Events that change the simulation and go to the server, the camera, torch and flashlight toggles stay with the client
+	constexpr uint8 GameplayEvents = (uint8)EEvent::Shoot | (uint8)EEvent::Throw;
+
+	// Mouse units per quantization step of the look delta
+	constexpr float LookDeltaStep = 1.f / 32.f;
+
+	struct SFrame
+	{
+		uint32 tick = 0;
+		PlayerSimulation::TInputFlags flags = 0;
+		uint8 events = 0;
+		// Mouse delta of the tick in LookDeltaStep units
+		int16 lookDelta[2] = { 0, 0 };
+
+		Vec2 GetLookDelta() const { return Vec2(lookDelta[0] * LookDeltaStep, lookDelta[1] * LookDeltaStep); }
+		bool HasEvent(EEvent event) const { return (events & (uint8)event) != 0; }
+	};
+
+	class CRing
+	{
+	public:
+		// Power of two, about a second of input at 60 ticks per second
+		static const uint32 Capacity = 64;
+		static_assert((Capacity & (Capacity - 1)) == 0, "Input ring capacity must be a power of two");
+
+	public:
+		// Frame being assembled, written by input callbacks
+		void SetFlags(PlayerSimulation::TInputFlags flags) { m_flags = flags; }
+		PlayerSimulation::TInputFlags GetFlags() const { return m_flags; }
+		void AddLookDelta(const Vec2& delta) { m_lookDelta += delta; }
+		void AddEvent(EEvent event) { m_events |= (uint8)event; }
+		void AddEvents(uint8 events) { m_events |= events; }
+
+		// Closes the frame being assembled as the next tick and returns it
+		// Held flags carry over to the next frame, the part of the look delta lost to quantization as well
+		const SFrame& Commit()
+		{
+			SFrame& frame = m_frames[m_nextTick & (Capacity - 1)];
+			frame.tick = m_nextTick++;
+			frame.flags = m_flags;
+			frame.events = m_events;
+
+			for (int i = 0; i < 2; ++i)
+			{
+				const float steps = CLAMP(floor(m_lookDelta[i] / LookDeltaStep + 0.5f), -32768.f, 32767.f);
+				frame.lookDelta[i] = static_cast<int16>(steps);
+				m_lookDelta[i] -= steps * LookDeltaStep;
+			}
+
+			m_events = 0;
+			if (m_count < Capacity)
+				++m_count;
+			return frame;
+		}
+
+		// Committed frame of a tick, nullptr if it was never committed or was overwritten since
+		const SFrame* Find(uint32 tick) const
+		{
+			if (tick >= m_nextTick || m_nextTick - tick > m_count)
+				return nullptr;
+
+			return &m_frames[tick & (Capacity - 1)];
+		}
+
+		// Last committed frame, only valid after the first Commit
+		const SFrame& GetLatest() const { return m_frames[(m_nextTick - 1) & (Capacity - 1)]; }
+		uint32 GetNextTick() const { return m_nextTick; }
+
+		// Drops held input and the frame being assembled, ticks keep counting
+		void Clear()
+		{
+			m_flags = 0;
+			m_events = 0;
+			m_lookDelta = ZERO;
+		}
+
+	protected:
+		SFrame m_frames[Capacity];
+		uint32 m_count = 0;
+		uint32 m_nextTick = 1;
+
+		PlayerSimulation::TInputFlags m_flags = 0;
+		uint8 m_events = 0;
+		Vec2 m_lookDelta = ZERO;
+	};
+}
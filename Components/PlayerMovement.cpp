@@ -1,97 +1,19 @@
 #include "Player.h"
 
-void CPlayerComponent::InitializeMovement(float frameTime)
+void CPlayerComponent::UpdateMovementRequest(const PlayerSimulation::SPlayerBatch& batch, uint32 index)
 {
 	// Don't handle input if we are in air
-	if (!m_pCharacterController->IsOnGround())
+	if (batch.onGround[index] == 0)
 		return;
 
-	Vec3 velocity = ZERO;
+	const uint8 conditions = batch.conditions[index];
+	m_moving = (conditions & PlayerStateMachine::eCondition_Moving) != 0;
+	m_crouchPress = (conditions & PlayerStateMachine::eCondition_Crouch) != 0;
+	m_isWeaponDrawn = (conditions & PlayerStateMachine::eCondition_WeaponDrawn) != 0;
 
-	float moveSpeed = gEnv->pConsole->GetCVar("g_WalkingSpeed")->GetFVal();
-	float crouchSpeed = 10.0f;
-	m_moving = false;
+	// Only reaches the attachment when the flag changed
+	m_attachments.SetVisible(CPlayerAttachments::EAttachment::Weapon, m_isWeaponDrawn);
 
-	if (m_inputFlags & (TInputFlags)EInputFlag::Crouch)
-	{
-		m_crouchPress = true;
-		//moveSpeed = 10.0f;
-	}
-	else
-	{
-		m_crouchPress = false;
-	}
-
-	if (m_inputFlags & (TInputFlags)EInputFlag::WeaponDrawn)
-	{
-		m_isWeaponDrawn = true;
-		if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
-		{
-			auto *pBarrelOutAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("weapon");
-			pBarrelOutAttachment->HideAttachment(0);
-		}
-	}
-	else
-	{
-		if (ICharacterInstance *pCharacter = m_pAnimationComponent->GetCharacter())
-		{
-			auto *pBarrelOutAttachment = pCharacter->GetIAttachmentManager()->GetInterfaceByName("weapon");
-			pBarrelOutAttachment->HideAttachment(1);
-		}
-		m_isWeaponDrawn = false;
-	}
-
-	if (m_inputFlags & (TInputFlags)EInputFlag::MoveLeft && m_State != EPlayerState::ePS_Interuptable)
-	{
-		m_moving = true;
-		if (m_crouchPress)
-		{
-			velocity.x -= crouchSpeed * frameTime;
-		}
-		else
-		{
-			velocity.x -= moveSpeed * frameTime;
-
-		}
-	}
-	if (m_inputFlags & (TInputFlags)EInputFlag::MoveRight && m_State != EPlayerState::ePS_Interuptable)
-	{
-		m_moving = true;
-		if (m_crouchPress)
-		{
-			velocity.x += crouchSpeed * frameTime;
-		}
-		else
-		{
-			velocity.x += moveSpeed * frameTime;
-		}
-	}
-	if (m_inputFlags & (TInputFlags)EInputFlag::MoveForward && m_State != EPlayerState::ePS_Interuptable)
-	{
-		m_moving = true;
-		if (m_crouchPress)
-		{
-			velocity.y += crouchSpeed * frameTime;
-		}
-		else
-		{
-			velocity.y += moveSpeed * frameTime;
-		}
-	}
-	if (m_inputFlags & (TInputFlags)EInputFlag::MoveBack && m_State != EPlayerState::ePS_Interuptable)
-	{
-		m_moving = true;
-		if (m_crouchPress)
-		{
-			velocity.y -= crouchSpeed * frameTime;
-		}
-		else
-		{
-			velocity.y -= moveSpeed * frameTime;
-		}
-	}
-
-	m_pCharacterController->AddVelocity(GetEntity()->GetWorldRotation() * velocity);
+	// Along the yaw of the previous step rather than the interpolated entity rotation, same as MovementPrediction::Step
+	m_pCharacterController->AddVelocity(m_lookAngles.GetYawOrientation() * batch.velocities[index]);
 }
-
-
@@ -0,0 +1,189 @@
+#include "Player.h"
+#include "../GamePlugin.h"
+
+#include <CrySystem/IConsole.h>
+
+namespace
+{
+	bool IsPredictionEnabled()
+	{
+		static ICVar* pPrediction = gEnv->pConsole->GetCVar("g_netPrediction");
+		return pPrediction != nullptr && pPrediction->GetIVal() != 0;
+	}
+}
+
+void CPlayerComponent::InitializeNetworking()
+{
+	// Unreliable, every packet repeats the commands that weren't acknowledged and every state supersedes the last one
+	SRmi<RMI_WRAP(&CPlayerComponent::ServerInput)>::Register(this, eRAT_NoAttach, true, eNRT_UnreliableOrdered);
+	SRmi<RMI_WRAP(&CPlayerComponent::ClientCorrection)>::Register(this, eRAT_NoAttach, false, eNRT_UnreliableOrdered);
+
+	ResetNetworking();
+}
+
+void CPlayerComponent::ResetNetworking()
+{
+	// Sequences start over with the next client
+	m_predictor.Reset();
+	m_authority.Reset();
+	m_firstRemoteCommand = 0;
+	m_remoteCommandCount = 0;
+	m_remoteCommandTime = 0.f;
+	m_appliedSequence = 0;
+	// Until the client's first packet arrives
+	m_remoteLookSettings = CUserSettings::Get();
+}
+
+bool CPlayerComponent::IsPredicting() const
+{
+	return IsPredictionEnabled() && !gEnv->bServer && (GetEntity()->GetFlags() & ENTITY_FLAG_LOCAL_PLAYER) != 0;
+}
+
+bool CPlayerComponent::IsRemotelyControlled() const
+{
+	return IsPredictionEnabled() && gEnv->bServer && (GetEntity()->GetFlags() & ENTITY_FLAG_LOCAL_PLAYER) == 0;
+}
+
+bool CPlayerComponent::ServerInput(SInputPacket&& packet, INetChannel* pNetChannel)
+{
+	// Only the owning client moves the player
+	if (gEnv->pGameFramework->GetGameChannelId(pNetChannel) != GetEntity()->GetNetEntity()->GetChannelId())
+		return true;
+
+	// Applied when the player gathers its next step, see CPlayerComponent::GatherSimulation
+	m_remoteLookSettings.mouseFilter = packet.lookFilter;
+	m_remoteLookSettings.mouseFilterTimeConstant = max(packet.lookFilterTimeConstant, 0.f);
+	m_remoteLookSettings.mouseFilterMinCutoff = max(packet.lookFilterMinCutoff, 0.f);
+	m_remoteLookSettings.mouseFilterBeta = max(packet.lookFilterBeta, 0.f);
+
+	for (uint32 i = 0; i < packet.count; ++i)
+	{
+		if (!m_authority.Accept(packet.commands[i]))
+			continue;
+
+		// Queue full, the client is too far ahead of the server step
+		if (m_remoteCommandCount == MaxQueuedCommands)
+		{
+			++CMovementAuthority::s_statistics.caughtUp;
+			ApplyRemoteCommand(m_remoteCommands[m_firstRemoteCommand]);
+			m_firstRemoteCommand = (m_firstRemoteCommand + 1) % MaxQueuedCommands;
+			--m_remoteCommandCount;
+		}
+
+		m_remoteCommands[(m_firstRemoteCommand + m_remoteCommandCount) % MaxQueuedCommands] = packet.commands[i];
+		++m_remoteCommandCount;
+	}
+
+	return true;
+}
+
+bool CPlayerComponent::ClientCorrection(SStatePacket&& packet, INetChannel* pNetChannel)
+{
+	MovementPrediction::SMovementState authoritative;
+	authoritative.position = packet.position;
+	authoritative.look.yaw = packet.lookYaw;
+	authoritative.look.pitch = packet.lookPitch;
+	authoritative.state = static_cast<EPlayerState>(min<uint8>(packet.state, ePS_Last - 1));
+	authoritative.conditions = packet.conditions;
+
+	// The look orientation stays with the client, the server only decides where the player is and what it does
+	MovementPrediction::SMovementState corrected;
+	if (m_predictor.Reconcile(packet.ackSequence, authoritative, CUserSettings::Get(), corrected))
+	{
+		GetEntity()->SetPos(corrected.position);
+		m_State = corrected.state;
+	}
+
+	return true;
+}
+
+void CPlayerComponent::ConsumeRemoteCommands(float stepTime)
+{
+	// Without new input the player keeps holding what it held, mouse movement and one-shot actions aren't repeated
+	// Commands cover the client's step time, as many are taken as fit into the server's, so differing step rates keep the same speed
+	m_remoteCommandTime += stepTime;
+
+	uint32 consumed = 0;
+	while (m_remoteCommandCount > 0)
+	{
+		const MovementPrediction::SInputCommand& command = m_remoteCommands[m_firstRemoteCommand];
+		if (max(command.frameTime, 0.f) > m_remoteCommandTime)
+			break;
+
+		ApplyRemoteCommand(command);
+		m_firstRemoteCommand = (m_firstRemoteCommand + 1) % MaxQueuedCommands;
+		--m_remoteCommandCount;
+		++consumed;
+	}
+
+	if (consumed > 1)
+	{
+		CMovementAuthority::s_statistics.merged += consumed - 1;
+	}
+
+	// Time without commands isn't made up for later, a burst after a stall is applied at the normal rate
+	if (m_remoteCommandCount == 0)
+	{
+		m_remoteCommandTime = min(m_remoteCommandTime, stepTime);
+	}
+}
+
+void CPlayerComponent::ApplyRemoteCommand(const MovementPrediction::SInputCommand& command)
+{
+	// Goes through the input ring like local input, several commands in one step add up like several input callbacks
+	m_inputRing.SetFlags(command.inputFlags);
+	m_inputRing.AddLookDelta(command.lookDelta);
+	m_inputRing.AddEvents(command.events & PlayerInput::GameplayEvents);
+	m_appliedSequence = command.sequence;
+
+	m_remoteCommandTime = max(m_remoteCommandTime - max(command.frameTime, 0.f), 0.f);
+}
+
+void CPlayerComponent::UpdateNetworking(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float frameTime)
+{
+	if (IsPredicting())
+	{
+		// The input frame the simulation consumed this tick
+		const PlayerInput::SFrame& input = m_inputRing.GetLatest();
+
+		MovementPrediction::SInputCommand command;
+		command.sequence = input.tick;
+		command.inputFlags = input.flags;
+		command.events = input.events & PlayerInput::GameplayEvents;
+		command.lookDelta = input.GetLookDelta();
+		command.frameTime = frameTime;
+		m_predictor.Record(command, GetMovementState());
+
+		const SGameSettings& settings = CUserSettings::Get();
+		SInputPacket packet;
+		packet.count = m_predictor.GetCommandsToSend(packet.commands, CMovementPredictor::RedundantCommands);
+		packet.lookFilter = static_cast<uint8>(CLAMP(settings.mouseFilter, 0, (int)PlayerInput::EFilter::Last - 1));
+		packet.lookFilterTimeConstant = settings.mouseFilterTimeConstant;
+		packet.lookFilterMinCutoff = settings.mouseFilterMinCutoff;
+		packet.lookFilterBeta = settings.mouseFilterBeta;
+		SRmi<RMI_WRAP(&CPlayerComponent::ServerInput)>::InvokeOnServer(this, std::move(packet));
+	}
+	else if (IsRemotelyControlled() && m_appliedSequence != 0)
+	{
+		const MovementPrediction::SMovementState state = GetMovementState();
+
+		SStatePacket packet;
+		packet.ackSequence = m_appliedSequence;
+		packet.position = state.position;
+		packet.lookYaw = state.look.yaw;
+		packet.lookPitch = state.look.pitch;
+		packet.state = static_cast<uint8>(state.state);
+		packet.conditions = state.conditions;
+		SRmi<RMI_WRAP(&CPlayerComponent::ClientCorrection)>::InvokeOnClient(this, std::move(packet), GetEntity()->GetNetEntity()->GetChannelId());
+	}
+}
+
+MovementPrediction::SMovementState CPlayerComponent::GetMovementState() const
+{
+	MovementPrediction::SMovementState state;
+	state.position = GetEntity()->GetWorldPos();
+	state.look = m_lookAngles;
+	state.state = m_State;
+	state.conditions = PlayerStateMachine::PackConditions(m_moving, m_crouchPress, m_isWeaponDrawn, m_canStand, m_throwAnim);
+	return state;
+}
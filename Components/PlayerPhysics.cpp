@@ -0,0 +1,123 @@
+#include "Player.h"
+#include "../Systems/EventLog.h"
+
+#include <CrySystem/IConsole.h>
+
+namespace
+{
+	// Minimum time between two collider swaps, so that crouch spam can't flap the shape every frame
+	const float ColliderSwapInterval = 0.15f;
+
+	struct SColliderStatistics
+	{
+		// In-place shape changes through pe_player_dimensions
+		uint32 swaps = 0;
+		// Swaps postponed by ColliderSwapInterval
+		uint32 deferred = 0;
+		// Full PE_LIVING rebuilds
+		uint32 rebuilds = 0;
+		CTimeValue since;
+	};
+
+	SColliderStatistics s_colliderStatistics;
+
+	// Stand and crouch shapes, indexed by PlayerStateMachine::ECollider
+	const pe_player_dimensions& GetColliderDimensions(PlayerStateMachine::ECollider collider)
+	{
+		static pe_player_dimensions s_dimensions[3];
+		static bool s_bInitialized = false;
+
+		if (!s_bInitialized)
+		{
+			for (pe_player_dimensions& dimensions : s_dimensions)
+			{
+				dimensions.bUseCapsule = 1;
+				// Keep pivot at the player's feet (defined in player geometry)
+				dimensions.heightPivot = 0.f;
+				dimensions.groundContactEps = 0.004f;
+			}
+
+			pe_player_dimensions& standing = s_dimensions[(int)PlayerStateMachine::ECollider::Standing];
+			standing.sizeCollider = Vec3(0.35f, 0.35f, 0.5f);
+			standing.heightCollider = 1.f;
+
+			pe_player_dimensions& crouching = s_dimensions[(int)PlayerStateMachine::ECollider::Crouching];
+			crouching.sizeCollider = Vec3(0.35f, 0.35f, 0.2f);
+			crouching.heightCollider = 0.8f;
+
+			s_dimensions[(int)PlayerStateMachine::ECollider::Keep] = standing;
+			s_bInitialized = true;
+		}
+
+		return s_dimensions[(int)collider];
+	}
+}
+
+void CPlayerComponent::Physicalize()
+{
+	// Physicalize the player as type Living.
+	// This physical entity type is specifically implemented for players
+	SEntityPhysicalizeParams physParams;
+	physParams.type = PE_LIVING;
+
+	physParams.mass = 100.0f;
+	CEventLog::Write(EventLog::EEvent::ColliderRebuild, GetEntityId());
+
+	pe_player_dimensions playerDimensions = GetColliderDimensions(PlayerStateMachine::ECollider::Standing);
+	physParams.pPlayerDimensions = &playerDimensions;
+
+	pe_player_dynamics playerDynamics;
+	playerDynamics.kAirControl = 0.f;
+	playerDynamics.mass = physParams.mass;
+	physParams.pPlayerDynamics = &playerDynamics;
+
+	GetEntity()->Physicalize(physParams);
+
+	m_collider = m_desiredCollider = PlayerStateMachine::ECollider::Standing;
+	m_colliderSwapTimer = 0.f;
+	++s_colliderStatistics.rebuilds;
+}
+
+void CPlayerComponent::UpdateCollider(float frameTime)
+{
+	m_colliderSwapTimer += frameTime;
+
+	if (m_desiredCollider == m_collider || m_desiredCollider == PlayerStateMachine::ECollider::Keep)
+		return;
+
+	if (m_colliderSwapTimer < ColliderSwapInterval)
+	{
+		++s_colliderStatistics.deferred;
+		return;
+	}
+
+	IPhysicalEntity* pPhysics = GetEntity()->GetPhysics();
+	if (pPhysics == nullptr || pPhysics->GetType() != PE_LIVING)
+	{
+		Physicalize();
+		return;
+	}
+
+	// Resize the existing living entity, fails if the new shape doesn't fit at the current position
+	pe_player_dimensions playerDimensions = GetColliderDimensions(m_desiredCollider);
+	if (pPhysics->SetParams(&playerDimensions) == 0)
+		return;
+
+	CEventLog::Write(EventLog::EEvent::ColliderSwap, GetEntityId(), m_desiredCollider == PlayerStateMachine::ECollider::Crouching ? 1.f : 0.f);
+
+	m_collider = m_desiredCollider;
+	m_colliderSwapTimer = 0.f;
+	++s_colliderStatistics.swaps;
+}
+
+void CPlayerComponent::LogColliderStatistics(IConsoleCmdArgs* pArgs)
+{
+	const CTimeValue now = gEnv->pTimer->GetAsyncTime();
+	const float seconds = max((now - s_colliderStatistics.since).GetSeconds(), 0.001f);
+
+	CryLogAlways("Player colliders: %.2f swaps/s (%u swaps, %u deferred, %u full rebuilds over %.1f s)",
+		s_colliderStatistics.swaps / seconds, s_colliderStatistics.swaps, s_colliderStatistics.deferred, s_colliderStatistics.rebuilds, seconds);
+
+	s_colliderStatistics = SColliderStatistics();
+	s_colliderStatistics.since = now;
+}
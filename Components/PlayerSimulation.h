@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+
+#include <CryMath/Cry_Camera.h>
+
+#include "PlayerStateMachine.h"
+#include "../UserSettings.h"
+
+////////////////////////////////////////////////////////
+// Per-frame player simulation steps that don't touch entities, physics or animation
+// Players are simulated in contiguous arrays, either one at a time by the component or many at once by CPlayerUpdateSystem
+// Anything reading or writing the engine happens before (gather) or after (apply) in CPlayerComponent
+////////////////////////////////////////////////////////
+namespace PlayerSimulation
+{
+	typedef uint8 TInputFlags;
+
+	enum class EInputFlag
+		: TInputFlags
+	{
+		MoveLeft = 1 << 0,
+		MoveRight = 1 << 1,
+		MoveForward = 1 << 2,
+		MoveBack = 1 << 3,
+		Crouch = 1 << 4,
+		WeaponDrawn = 1 << 5
+	};
+
+	// Canonical look state in radians, no roll
+	// Simulated, predicted and sent as two scalars, orientations are derived from it only where the engine needs them
+	struct SLookAngles
+	{
+		// Around the world up axis, kept within [-pi, pi]
+		float yaw = 0.f;
+		// Up is positive, clamped to the pitch limits of the settings
+		float pitch = 0.f;
+
+		bool operator==(const SLookAngles& other) const { return yaw == other.yaw && pitch == other.pitch; }
+		bool operator!=(const SLookAngles& other) const { return !(*this == other); }
+
+		// Same as CCamera::CreateOrientationYPR without roll
+		Quat GetOrientation() const { return Quat::CreateRotationZ(yaw) * Quat::CreateRotationX(pitch); }
+		Quat GetYawOrientation() const { return Quat::CreateRotationZ(yaw); }
+	};
+
+	inline float WrapAngle(float angle)
+	{
+		if (angle > gf_PI || angle < -gf_PI)
+		{
+			angle -= gf_PI2 * floor_tpl((angle + gf_PI) / gf_PI2);
+		}
+		return angle;
+	}
+
+	// Shortest way between two look states, t of 0 is from and 1 is to
+	inline SLookAngles InterpolateLook(const SLookAngles& from, const SLookAngles& to, float t)
+	{
+		SLookAngles look;
+		look.yaw = WrapAngle(from.yaw + WrapAngle(to.yaw - from.yaw) * t);
+		look.pitch = from.pitch + (to.pitch - from.pitch) * t;
+		return look;
+	}
+
+	// Hot simulation state of a set of players, one entry per player in each array
+	struct SPlayerBatch
+	{
+		void Resize(uint32 count)
+		{
+			inputFlags.resize(count, 0);
+			onGround.resize(count, 0);
+			lookDeltas.resize(count, Vec2(ZERO));
+			conditions.resize(count, 0);
+			states.resize(count, ePS_Standing);
+			lookAngles.resize(count, SLookAngles());
+			velocities.resize(count, Vec3(ZERO));
+			angularVelocities.resize(count, 0.f);
+			colliders.resize(count, PlayerStateMachine::ECollider::Keep);
+		}
+
+		// Moves the last player into the entry of a removed one
+		void RemoveSwap(uint32 index)
+		{
+			const uint32 last = GetCount() - 1;
+			inputFlags[index] = inputFlags[last];
+			onGround[index] = onGround[last];
+			lookDeltas[index] = lookDeltas[last];
+			conditions[index] = conditions[last];
+			states[index] = states[last];
+			lookAngles[index] = lookAngles[last];
+			velocities[index] = velocities[last];
+			angularVelocities[index] = angularVelocities[last];
+			colliders[index] = colliders[last];
+			Resize(last);
+		}
+
+		uint32 GetCount() const { return static_cast<uint32>(states.size()); }
+
+		// Gathered from the players
+		std::vector<TInputFlags> inputFlags;
+		std::vector<uint8> onGround;
+		// Smoothed mouse delta of this frame
+		std::vector<Vec2> lookDeltas;
+
+		// Updated in place
+		// PlayerStateMachine condition bits, moving, crouch and weapon drawn are rewritten by the movement step while on ground
+		std::vector<uint8> conditions;
+		// Current state before simulating, next state afterwards
+		std::vector<EPlayerState> states;
+		std::vector<SLookAngles> lookAngles;
+
+		// Results
+		// Velocity request in entity space, zero while in air
+		std::vector<Vec3> velocities;
+		// Yaw change per second, radians
+		std::vector<float> angularVelocities;
+		std::vector<PlayerStateMachine::ECollider> colliders;
+	};
+
+	inline Vec3 StepMovement(TInputFlags inputFlags, EPlayerState state, const SGameSettings& settings, float frameTime, uint8& conditions)
+	{
+		using namespace PlayerStateMachine;
+
+		const bool crouch = (inputFlags & (TInputFlags)EInputFlag::Crouch) != 0;
+		const bool weaponDrawn = (inputFlags & (TInputFlags)EInputFlag::WeaponDrawn) != 0;
+		const float speed = crouch ? settings.crouchSpeed : settings.walkSpeed;
+
+		Vec3 velocity = ZERO;
+		bool moving = false;
+
+		// Movement input is ignored while a throw can't be interrupted
+		if (state != ePS_Interuptable)
+		{
+			if (inputFlags & (TInputFlags)EInputFlag::MoveLeft)
+			{
+				moving = true;
+				velocity.x -= speed * frameTime;
+			}
+			if (inputFlags & (TInputFlags)EInputFlag::MoveRight)
+			{
+				moving = true;
+				velocity.x += speed * frameTime;
+			}
+			if (inputFlags & (TInputFlags)EInputFlag::MoveForward)
+			{
+				moving = true;
+				velocity.y += speed * frameTime;
+			}
+			if (inputFlags & (TInputFlags)EInputFlag::MoveBack)
+			{
+				moving = true;
+				velocity.y -= speed * frameTime;
+			}
+		}
+
+		conditions = (conditions & ~(eCondition_Moving | eCondition_Crouch | eCondition_WeaponDrawn))
+			| (moving ? eCondition_Moving : 0) | (crouch ? eCondition_Crouch : 0) | (weaponDrawn ? eCondition_WeaponDrawn : 0);
+
+		return velocity;
+	}
+
+	inline SLookAngles StepLook(const SLookAngles& look, const Vec2& lookDelta, const SGameSettings& settings)
+	{
+		SLookAngles next;
+
+		// Yaw
+		next.yaw = WrapAngle(look.yaw + lookDelta.x * settings.rotationSpeed);
+
+		// Pitch
+		// TODO: Perform soft clamp here instead of hard wall, should reduce rot speed in this direction when close to limit.
+		next.pitch = CLAMP(look.pitch + lookDelta.y * settings.rotationSpeed, settings.minPitch, settings.maxPitch);
+
+		return next;
+	}
+
+	// Movement, look and state machine steps for players [begin, end), safe to run on any thread
+	inline void SimulateRange(SPlayerBatch& batch, uint32 begin, uint32 end, const SGameSettings& settings, float frameTime)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			// Movement, input isn't handled in air
+			if (batch.onGround[i] != 0)
+			{
+				batch.velocities[i] = StepMovement(batch.inputFlags[i], batch.states[i], settings, frameTime, batch.conditions[i]);
+			}
+			else
+			{
+				batch.velocities[i] = ZERO;
+			}
+
+			// Look
+			batch.angularVelocities[i] = (batch.lookDeltas[i].x * settings.rotationSpeed) / frameTime;
+			batch.lookAngles[i] = StepLook(batch.lookAngles[i], batch.lookDeltas[i], settings);
+
+			// State machine
+			const PlayerStateMachine::STransition& transition = PlayerStateMachine::Lookup(batch.states[i], batch.conditions[i]);
+			batch.states[i] = transition.next;
+			batch.colliders[i] = transition.collider;
+		}
+	}
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+struct IConsoleCmdArgs;
+
+enum EPlayerState
+{
+	ePS_None,
+	ePS_Standing,
+	ePS_MovingToStanding,
+	ePS_Crouching,
+	ePS_MovingToCrouching,
+	ePS_Jumping,
+	ePS_WeaponMove,
+	ePS_WeaponIdle,
+	ePS_Interuptable,
+	ePS_Last
+};
+
+////////////////////////////////////////////////////////
+// Player state transitions, compiled into a table indexed by (state, packed conditions)
+// Stepping a player is a single lookup giving the next state and the collider it needs, fragments are looked up per state
+////////////////////////////////////////////////////////
+namespace PlayerStateMachine
+{
+	// Conditions sampled once per frame and packed into the table index
+	enum ECondition : uint8
+	{
+		eCondition_Moving = 1 << 0,
+		eCondition_Crouch = 1 << 1,
+		eCondition_WeaponDrawn = 1 << 2,
+		eCondition_CanStand = 1 << 3,
+		eCondition_ThrowAnim = 1 << 4,
+		eCondition_Count = 1 << 5
+	};
+
+	// Physics shape required by a transition
+	enum class ECollider : uint8
+	{
+		Keep,
+		Standing,
+		Crouching
+	};
+
+	// Mannequin fragment played in a state, resolved to fragment IDs by the player
+	enum class EFragment : uint8
+	{
+		Keep,
+		Idle,
+		Walk,
+		CrouchIdle,
+		CrouchWalk,
+		IdleWithWeapon,
+		WalkWithWeapon,
+		StoneThrow
+	};
+
+	struct STransition
+	{
+		EPlayerState next;
+		ECollider collider;
+	};
+
+	constexpr uint8 PackConditions(bool moving, bool crouch, bool weaponDrawn, bool canStand, bool throwAnim)
+	{
+		return (moving ? eCondition_Moving : 0) | (crouch ? eCondition_Crouch : 0) | (weaponDrawn ? eCondition_WeaponDrawn : 0)
+			| (canStand ? eCondition_CanStand : 0) | (throwAnim ? eCondition_ThrowAnim : 0);
+	}
+
+	// Reference transition logic, the table is generated from it at compile time
+	// Also used at runtime by the benchmark as the branching baseline
+	constexpr STransition Step(EPlayerState state, uint8 conditions)
+	{
+		const bool moving = (conditions & eCondition_Moving) != 0;
+		const bool crouch = (conditions & eCondition_Crouch) != 0;
+		const bool weaponDrawn = (conditions & eCondition_WeaponDrawn) != 0;
+		const bool canStand = (conditions & eCondition_CanStand) != 0;
+		const bool throwAnim = (conditions & eCondition_ThrowAnim) != 0;
+
+		switch (state)
+		{
+		case ePS_Interuptable:
+			return { throwAnim ? ePS_Interuptable : ePS_Standing, ECollider::Keep };
+
+		case ePS_Standing:
+			if (weaponDrawn)
+				return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+			if (moving)
+				return crouch ? STransition{ ePS_MovingToCrouching, ECollider::Crouching } : STransition{ ePS_MovingToStanding, ECollider::Standing };
+			return crouch ? STransition{ ePS_Crouching, ECollider::Crouching } : STransition{ ePS_Standing, ECollider::Keep };
+
+		case ePS_Crouching:
+			if (weaponDrawn)
+				return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+			if (moving)
+				return crouch || !canStand ? STransition{ ePS_MovingToCrouching, ECollider::Crouching } : STransition{ ePS_MovingToStanding, ECollider::Standing };
+			if (crouch)
+				return { ePS_Crouching, ECollider::Keep };
+			return canStand ? STransition{ ePS_Standing, ECollider::Standing } : STransition{ ePS_Crouching, ECollider::Crouching };
+
+		case ePS_MovingToStanding:
+			if (weaponDrawn)
+				return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+			if (moving)
+				return crouch ? STransition{ ePS_MovingToCrouching, ECollider::Crouching } : STransition{ ePS_MovingToStanding, ECollider::Keep };
+			return { crouch ? ePS_Crouching : ePS_Standing, ECollider::Keep };
+
+		case ePS_MovingToCrouching:
+			if (weaponDrawn)
+				return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+			if (moving)
+			{
+				if (crouch)
+					return { ePS_MovingToCrouching, ECollider::Keep };
+				return canStand ? STransition{ ePS_MovingToStanding, ECollider::Standing } : STransition{ ePS_MovingToCrouching, ECollider::Crouching };
+			}
+			return { !crouch && canStand ? ePS_Standing : ePS_Crouching, ECollider::Keep };
+
+		case ePS_WeaponMove:
+			if (!weaponDrawn)
+				return { moving ? ePS_MovingToStanding : ePS_Standing, ECollider::Keep };
+			return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+
+		case ePS_WeaponIdle:
+			if (!weaponDrawn)
+				return { moving ? ePS_MovingToStanding : ePS_Standing, ECollider::Keep };
+			return { moving ? ePS_WeaponMove : ePS_WeaponIdle, ECollider::Keep };
+
+		default:
+			return { state, ECollider::Keep };
+		}
+	}
+
+	constexpr EFragment GetFragment(EPlayerState state)
+	{
+		switch (state)
+		{
+		case ePS_Standing: return EFragment::Idle;
+		case ePS_MovingToStanding: return EFragment::Walk;
+		case ePS_Crouching: return EFragment::CrouchIdle;
+		case ePS_MovingToCrouching: return EFragment::CrouchWalk;
+		case ePS_WeaponMove: return EFragment::WalkWithWeapon;
+		case ePS_WeaponIdle: return EFragment::IdleWithWeapon;
+		case ePS_Interuptable: return EFragment::StoneThrow;
+		default: return EFragment::Keep;
+		}
+	}
+
+	struct STable
+	{
+		STransition entries[ePS_Last][eCondition_Count];
+		EFragment fragments[ePS_Last];
+	};
+
+	constexpr STable BuildTable()
+	{
+		STable table = {};
+		for (int state = 0; state < ePS_Last; ++state)
+		{
+			for (int conditions = 0; conditions < eCondition_Count; ++conditions)
+			{
+				table.entries[state][conditions] = Step(static_cast<EPlayerState>(state), static_cast<uint8>(conditions));
+			}
+			table.fragments[state] = GetFragment(static_cast<EPlayerState>(state));
+		}
+		return table;
+	}
+
+	constexpr STable Table = BuildTable();
+
+	// Every entry has to lead to a valid state
+	constexpr bool HasValidTargets()
+	{
+		for (int state = 0; state < ePS_Last; ++state)
+		{
+			for (int conditions = 0; conditions < eCondition_Count; ++conditions)
+			{
+				const EPlayerState next = Table.entries[state][conditions].next;
+				if (next < ePS_None || next >= ePS_Last)
+					return false;
+				if (next == ePS_None && state != ePS_None)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// States reachable from spawning (ePS_Standing) and from a throw (ePS_Interuptable, entered on input)
+	constexpr uint32 GetReachableStates()
+	{
+		uint32 reachable = BIT(ePS_Standing) | BIT(ePS_Interuptable);
+		for (bool bChanged = true; bChanged; )
+		{
+			bChanged = false;
+			for (int state = 0; state < ePS_Last; ++state)
+			{
+				if ((reachable & BIT(state)) == 0)
+					continue;
+
+				for (int conditions = 0; conditions < eCondition_Count; ++conditions)
+				{
+					const uint32 next = BIT(Table.entries[state][conditions].next);
+					if ((reachable & next) == 0)
+					{
+						reachable |= next;
+						bChanged = true;
+					}
+				}
+			}
+		}
+		return reachable;
+	}
+
+	// Every reachable state needs a fragment, every state with a fragment needs to be reachable
+	constexpr bool HasConsistentFragments()
+	{
+		const uint32 reachable = GetReachableStates();
+		for (int state = ePS_None + 1; state < ePS_Last; ++state)
+		{
+			const bool bReachable = (reachable & BIT(state)) != 0;
+			const bool bHasFragment = Table.fragments[state] != EFragment::Keep;
+			if (bReachable != bHasFragment)
+				return false;
+		}
+		return true;
+	}
+
+	static_assert(HasValidTargets(), "Player state table leads to an invalid state");
+	static_assert((GetReachableStates() & BIT(ePS_None)) == 0, "Player state table can fall back to ePS_None");
+	static_assert(HasConsistentFragments(), "Player state table has unreachable states or reachable states without a fragment");
+
+	inline const STransition& Lookup(EPlayerState state, uint8 conditions)
+	{
+		return Table.entries[state][conditions];
+	}
+
+	// Console command, steps N players (default 10000) through the branching reference and the table
+	void RunBenchmark(IConsoleCmdArgs* pArgs);
+}
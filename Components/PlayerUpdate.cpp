@@ -1,251 +1,174 @@
 #include "Player.h"
+#include "../GamePlugin.h"
 
-void CPlayerComponent::InitializeUpdate(EPlayerState state, float frameTime)
+#include <CrySystem/IConsole.h>
+
+namespace
+{
+	// Debug labels per state, weapon states had none
+	const char* const szStateLabels[ePS_Last] = { "", "standing", "standing moving", "crouching", "crouching moving", "", "", "", "throwing stone" };
+}
+
+void CPlayerComponent::GatherSimulation(PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime)
 {
-	IPersistantDebug *pPD = gEnv->pGameFramework->GetIPersistantDebug();
-	if (pPD)
+	// Picks up a swapped character instance
 	{
-		pPD->Begin("InteractionVector", false);
-		pPD->AddText(10.0f, 1.0f, 2.0f, ColorF(Vec3(0, 0, 0), 0.5f), 1.0f, "is crouch button pressed %d", m_crouchPress);
-		pPD->AddText(500.0f, 1.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "is moving %d", m_moving);
+		GAME_PROFILE_SCOPE("Player::UpdateAttachments");
+		m_attachments.Update(m_pAnimationComponent->GetCharacter());
 	}
-	switch (m_State)
+
+	// Players of other clients move by the commands their client sends
+	if (IsRemotelyControlled())
 	{
-	case EPlayerState::ePS_Interuptable:
-		pPD->AddText(10.0f, 50.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "throwing stone");
-		if (!m_throwAnim)
-		{
-			m_State = EPlayerState::ePS_Standing;
-		}
+		ConsumeRemoteCommands(stepTime);
+	}
 
-		break;
-	case EPlayerState::ePS_Standing:
-		pPD->AddText(10.0f, 50.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "standing");
-		if (m_moving)
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponMove;
-			}
-			else
-			{
-				if (!m_crouchPress)
-				{
-					if (!m_standPhys)
-						Physicalize();
-					m_State = EPlayerState::ePS_MovingToStanding;
-				}
-				else
-				{
-					if (!m_crouchPhys)
-						PhysicalizeCrouch();
-					m_State = EPlayerState::ePS_MovingToCrouching;
-				}
-			}
-		}
-		else
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponIdle;
-			}
-			else
-			{
-				if (!m_crouchPress)
-				{
-					m_State = EPlayerState::ePS_Standing;
-				}
-				else
-				{
-					if (!m_crouchPhys)
-						PhysicalizeCrouch();
-					m_State = EPlayerState::ePS_Crouching;
-				}
-			}
-		}
-		break;
-	case EPlayerState::ePS_Crouching:
-		pPD->AddText(10.0f, 90.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "crouching");
-		if (m_moving)
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponMove;
-			}
-			else
-			{
-				if (m_crouchPress)
-				{
-					if (!m_crouchPhys)
-						PhysicalizeCrouch();
-					m_State = EPlayerState::ePS_MovingToCrouching;
-				}
-				else
-				{
-					if (!m_canStand)
-					{
-						if (!m_crouchPhys)
-							PhysicalizeCrouch();
-						m_State = EPlayerState::ePS_MovingToCrouching;
-					}
-					else
-					{
-						if (!m_standPhys)
-							Physicalize();
-						m_State = EPlayerState::ePS_MovingToStanding;
-					}
-				}
-			}
-		}
-		else
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponIdle;
-			}
-			else
-			{
-				if (!m_crouchPress)
-				{
-					if (m_canStand)
-					{
-						if (!m_standPhys)
-							Physicalize();
-						m_State = EPlayerState::ePS_Standing;
-					}
-					else
-					{
-						if (!m_crouchPhys)
-							PhysicalizeCrouch();
-						m_State = EPlayerState::ePS_Crouching;
-					}
-
-				}
-				else
-				{
-					m_State = EPlayerState::ePS_Crouching;
-				}
-			}
-		}
-		break;
+	// Players of a session replay take the recorded input of this tick instead, see g_sessionReplay
+	CSessionReplay::ApplyInput(GetEntityId(), m_inputRing);
 
-	case EPlayerState::ePS_MovingToStanding:
-		pPD->AddText(10.0f, 110.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "standing moving");
-		if (m_moving)
-		{
+	// Input of this tick, nothing past this point reads what the input callbacks wrote
+	const PlayerInput::SFrame& input = m_inputRing.Commit();
+	CSessionRecorder::RecordInput(GetEntityId(), input);
+	ProcessInputEvents(input);
 
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponMove;
-			}
-			else
-			{
-				if (m_crouchPress)
-				{
-					if (!m_crouchPhys)
-						PhysicalizeCrouch();
-					m_State = EPlayerState::ePS_MovingToCrouching;
-				}
-			}
-		}
-		else
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponIdle;
-			}
-			else
-			{
-				if (!m_crouchPress)
-					m_State = EPlayerState::ePS_Standing;
-				else
-					m_State = EPlayerState::ePS_Crouching;
-			}
-		}
-		break;
+	// Apply smoothing filter to the mouse input, see g_mouseFilter, players of other clients are smoothed like their client smooths them
+	PlayerInput::ConfigureLookFilter(m_mouseDeltaSmoothingFilter, IsRemotelyControlled() ? m_remoteLookSettings : CUserSettings::Get());
+	const Vec2 lookDelta = m_mouseDeltaSmoothingFilter.Push(input.GetLookDelta(), stepTime).Get();
 
-	case EPlayerState::ePS_MovingToCrouching:
-		pPD->AddText(10.0f, 130.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "crouching moving");
-		if (m_moving)
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponMove;
-			}
-			else
-			{
-				if (!m_crouchPress)
-				{
-					if (m_canStand)
-					{
-						if (!m_standPhys)
-							Physicalize();
-						m_State = EPlayerState::ePS_MovingToStanding;
-					}
-					else
-					{
-						if (!m_crouchPhys)
-							PhysicalizeCrouch();
-						m_State = EPlayerState::ePS_MovingToCrouching;
-					}
-
-				}
-			}
+	// Headroom ray of last frame, ShootRayFromHead reports the same result later this frame
+	m_canStand = !(m_headRayResult.distance < 1.0f && m_headRayResult.distance > 0.0f);
 
-		}
-		else
-		{
-			if (m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_WeaponIdle;
-			}
-			else
-			{
-				if (!m_crouchPress)
-				{
-					if (m_canStand)
-						m_State = EPlayerState::ePS_Standing;
-					else
-						m_State = EPlayerState::ePS_Crouching;
-				}
-				else
-					m_State = EPlayerState::ePS_Crouching;
-			}
+	batch.inputFlags[index] = input.flags;
+	batch.onGround[index] = m_pCharacterController->IsOnGround() ? 1 : 0;
+	batch.lookDeltas[index] = lookDelta;
+	batch.conditions[index] = PlayerStateMachine::PackConditions(m_moving, m_crouchPress, m_isWeaponDrawn, m_canStand, m_throwAnim);
+	batch.states[index] = m_State;
+	batch.lookAngles[index] = m_lookAngles;
+}
 
-		}
-		break;
-	case  EPlayerState::ePS_WeaponMove:
-		if (m_moving)
-		{
-			if (!m_isWeaponDrawn)
-				m_State = EPlayerState::ePS_MovingToStanding;
-		}
-		else
+void CPlayerComponent::ApplySimulation(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float stepTime)
+{
+	// Send the movement request to the character controller
+	// This results in the physical representation of the character moving
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateMovementRequest");
+		UpdateMovementRequest(batch, index);
+	}
+
+	// Take over the new look orientation
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateLookDirectionRequest");
+		UpdateLookDirectionRequest(batch, index, stepTime);
+	}
+
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateState");
+		UpdateState(batch, index, stepTime);
+	}
+
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateNetworking");
+		UpdateNetworking(batch, index, stepTime);
+	}
+}
+
+void CPlayerComponent::UpdateFrame(float frameTime, float alpha)
+{
+	// Look shown this frame, the simulation is at most one step ahead of it
+	m_renderLookAngles = PlayerSimulation::InterpolateLook(m_previousLookAngles, m_lookAngles, alpha);
+	UpdateLookCache();
+	UpdateFlashlight();
+
+	// Update the animation state of the character and the entity rotation
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateAnimation");
+		UpdateAnimation(frameTime);
+	}
+
+	// Update the camera component offset
+	{
+		GAME_PROFILE_SCOPE("Player::UpdateCamera");
+		UpdateCamera(frameTime);
+	}
+
+	{
+		GAME_PROFILE_SCOPE("Player::ShootRayFromHead");
+		ShootRayFromHead();
+	}
+
+	if (!m_isControllableReported)
+	{
+		m_isControllableReported = true;
+
+		const float timeMs = (gEnv->pTimer->GetAsyncTime() - m_spawnTime).GetMilliSeconds();
+		CryLog("Player %u controllable %.1f ms after spawning, %s load", GetEntityId(), timeMs, m_isStreamedLoad ? "streamed" : "synchronous");
+		if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
 		{
-			if (!m_isWeaponDrawn)
-				m_State = EPlayerState::ePS_Standing;
-			else
-				m_State = EPlayerState::ePS_WeaponIdle;
+			pPlugin->GetCharacterStreamer().RecordControllable(m_isStreamedLoad, timeMs);
 		}
-		break;
-	case EPlayerState::ePS_WeaponIdle:
-		if (m_moving)
+	}
+}
+
+void CPlayerComponent::UpdateState(const PlayerSimulation::SPlayerBatch& batch, uint32 index, float frameTime)
+{
+	GAME_DEBUG_DRAW(EDebugCategory::State, AddText, 10.0f, 1.0f, 2.0f, ColorF(Vec3(0, 0, 0), 0.5f), 1.0f, "is crouch button pressed %d", m_crouchPress);
+	GAME_DEBUG_DRAW(EDebugCategory::State, AddText, 500.0f, 1.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, "is moving %d", m_moving);
+	GAME_DEBUG_DRAW(EDebugCategory::State, AddText, 10.0f, 50.0f, 2.0f, ColorF(Vec3(0, 1, 0), 0.5f), 1.0f, szStateLabels[m_State]);
+
+	// The transition was looked up by PlayerSimulation::SimulateRange
+	if (batch.colliders[index] != PlayerStateMachine::ECollider::Keep)
+		m_desiredCollider = batch.colliders[index];
+
+	m_State = batch.states[index];
+
+	UpdateCollider(frameTime);
+}
+
+void PlayerStateMachine::RunBenchmark(IConsoleCmdArgs* pArgs)
+{
+	const int playerCount = pArgs->GetArgCount() > 1 ? max(atoi(pArgs->GetArg(1)), 1) : 10000;
+	const int frameCount = 100;
+
+	// Same random inputs for both runs, conditions change every frame
+	std::vector<uint8> conditions(playerCount * frameCount);
+	CRndGen random(0x5eed);
+	for (uint8& frameConditions : conditions)
+	{
+		frameConditions = static_cast<uint8>(random.GetRandom(0u, eCondition_Count - 1u));
+	}
+
+	std::vector<EPlayerState> states(playerCount, ePS_Standing);
+	uint32 colliderChanges = 0;
+
+	const CTimeValue branchStart = gEnv->pTimer->GetAsyncTime();
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		const uint8* pFrameConditions = &conditions[frame * playerCount];
+		for (int i = 0; i < playerCount; ++i)
 		{
-			if (!m_isWeaponDrawn)
-			{
-				m_State = EPlayerState::ePS_MovingToStanding;
-			}
-			else
-			{
-				m_State = EPlayerState::ePS_WeaponMove;
-			}
+			const STransition transition = Step(states[i], pFrameConditions[i]);
+			states[i] = transition.next;
+			colliderChanges += transition.collider != ECollider::Keep;
 		}
-		else
+	}
+	const float branchTimeMs = (gEnv->pTimer->GetAsyncTime() - branchStart).GetMilliSeconds();
+
+	std::fill(states.begin(), states.end(), ePS_Standing);
+
+	const CTimeValue tableStart = gEnv->pTimer->GetAsyncTime();
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		const uint8* pFrameConditions = &conditions[frame * playerCount];
+		for (int i = 0; i < playerCount; ++i)
 		{
-			if (!m_isWeaponDrawn)
-				m_State = EPlayerState::ePS_Standing;
+			const STransition& transition = Lookup(states[i], pFrameConditions[i]);
+			states[i] = transition.next;
+			colliderChanges -= transition.collider != ECollider::Keep;
 		}
-	default:
-		break;
 	}
-}
\ No newline at end of file
+	const float tableTimeMs = (gEnv->pTimer->GetAsyncTime() - tableStart).GetMilliSeconds();
+
+	// Both runs see the same transitions, the counter returns to zero if they agree
+	CryLogAlways("Player state machine, %d players: branches %.3f ms/frame, table %.3f ms/frame%s",
+		playerCount, branchTimeMs / frameCount, tableTimeMs / frameCount, colliderChanges == 0 ? "" : " (results differ!)");
+}
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "SpawnPoint.h"
+#include "../GamePlugin.h"
 
 #include <CrySchematyc/Reflection/TypeDesc.h>
 #include <CrySchematyc/Utils/EnumFlags.h>
@@ -25,6 +26,23 @@ static void RegisterSpawnPointComponent(Schematyc::IEnvRegistrar& registrar)
 
 CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterSpawnPointComponent)
 
+CSpawnPointComponent::~CSpawnPointComponent()
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetSpawnRegistry().Unregister(*this);
+	}
+}
+
+void CSpawnPointComponent::Initialize()
+{
+	// Revives pick from the registry instead of searching the entity system
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetSpawnRegistry().Register(*this);
+	}
+}
+
 void CSpawnPointComponent::SpawnEntity(IEntity* otherEntity)
 {
 	otherEntity->SetWorldTM(m_pEntity->GetWorldTM());
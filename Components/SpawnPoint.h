@@ -9,7 +9,11 @@ class CSpawnPointComponent final : public IEntityComponent
 {
 public:
 	CSpawnPointComponent() = default;
-	virtual ~CSpawnPointComponent() {}
+	virtual ~CSpawnPointComponent();
+
+	// IEntityComponent
+	virtual void Initialize() override;
+	// ~IEntityComponent
 
 	// Reflect type to set a unique identifier for this component
 	// and provide additional information to expose it in the sandbox
@@ -1,4 +1,5 @@
 #include "SurveillanceCamera.h"
+#include "../GamePlugin.h"
 
 static void RegisterSurveillanceCamera(Schematyc::IEnvRegistrar& registrar)
 {
@@ -9,6 +10,15 @@ static void RegisterSurveillanceCamera(Schematyc::IEnvRegistrar& registrar)
 }
 CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterSurveillanceCamera);
 
+CSurveillanceCameraComponent::~CSurveillanceCameraComponent()
+{
+	// Pending rays write into m_rayResult
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetRaycasts().Cancel(this);
+	}
+}
+
 void CSurveillanceCameraComponent::Initialize()
 {
 	SetComponentFlags(GetComponentFlags() | EEntityComponentFlags::NoSave);
@@ -69,26 +79,37 @@ void CSurveillanceCameraComponent::ReflectType(Schematyc::CTypeDesc<CSurveillanc
 
 IEntity* CSurveillanceCameraComponent::Raycast(Vec3 dir, Vec3 pos, float rayLength)
 {
-	ray_hit hit;
-	static const unsigned int rayFlags = rwi_stop_at_pierceable | rwi_colltype_any;
-	gEnv->pPhysicalWorld->RayWorldIntersection(pos, dir * rayLength, ent_living, rayFlags, &hit, 1, m_pEntity->GetPhysicalEntity());
-
-	if (hit.pCollider)
+	SRayRequest request;
+	request.origin = pos;
+	request.direction = dir * rayLength;
+	request.objectTypes = ent_living;
+	request.pSkipEntities[0] = m_pEntity->GetPhysicalEntity();
+	request.skipEntityCount = 1;
+	request.pOwner = this;
+	request.pResult = &m_rayResult;
+	CGamePlugin::GetInstance()->GetRaycasts().Submit(std::move(request));
+
+	if (m_rayResult.bHit)
 	{
-		IPhysicalEntity *pHitEntity = hit.pCollider;
-		IEntity *pEntity = gEnv->pEntitySystem->GetEntityFromPhysics(pHitEntity);
-
 		m_foundPlayer = true;
-		hitLocation = hit.pt;
-		return pEntity;
+		hitLocation = m_rayResult.point;
+		return gEnv->pEntitySystem->GetEntity(m_rayResult.entityId);
 	}
 	return NULL;
 }
 
+void CSurveillanceCameraComponent::ClearRay()
+{
+	// A ray of the previous search would otherwise report its hit again once searching resumes
+	CGamePlugin::GetInstance()->GetRaycasts().Cancel(this);
+	m_rayResult = SRayResult();
+}
+
 void CSurveillanceCameraComponent::Reset()
 {
 	//m_camSearch = Searching;
 	m_foundPlayer = false;
+	ClearRay();
 	//rotator = -1;
 
 	int componentSlot = GetOrMakeEntitySlotId();
@@ -96,7 +117,7 @@ void CSurveillanceCameraComponent::Reset()
 	GetEntity()->FreeSlot(componentSlot);
 	GetEntity()->UnphysicalizeSlot(componentSlot);
 
-	GetEntity()->LoadGeometry(componentSlot, m_surveillGeomPath.value);
+	GetEntity()->SetStatObj(CGamePlugin::GetInstance()->GetAssets().GetGeometry(m_surveillGeomPath.value), componentSlot, false);
 
 	SEntityPhysicalizeParams params;
 	//params.type = PE_RIGID;
@@ -2,12 +2,13 @@
 #include "StdAfx.h"
 #include <CryEntitySystem/IEntitySystem.h>
 #include <CrySchematyc/CoreAPI.h>
+#include "../Systems/RaycastService.h"
 
 class CSurveillanceCameraComponent final : public IEntityComponent
 {
 public:
 	CSurveillanceCameraComponent() {};
-	virtual ~CSurveillanceCameraComponent() {}
+	virtual ~CSurveillanceCameraComponent();
 
 	//IEntityComponent
 
@@ -21,12 +22,16 @@ public:
 	//static void Register(Schematyc::CEnvRegistrationScope& componentScope);
 	static void ReflectType(Schematyc::CTypeDesc<CSurveillanceCameraComponent>& desc);
 
+	// Submits a ray for this frame and returns the entity found by the previous one
 	IEntity* Raycast(Vec3 dir, Vec3 pos, float rayLength);
+	// Drops the pending rays and the last result, called whenever the camera leaves the search
+	void ClearRay();
 	void Reset();
 
 	bool m_isGameMode;
 	bool m_foundPlayer;
 	Vec3 hitLocation;
+	SRayResult m_rayResult;
 
 	Schematyc::GeomFileName m_surveillGeomPath = "Objects/player_use/surveilance_camera/surveillance_camera.cgf";
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "StdAfx.h"
 #include "SurveillanceComponent.h"
+#include "../GamePlugin.h"
 #include <CrySchematyc/Env/IEnvRegistrar.h>
 #include <CrySchematyc/Env/Elements/EnvComponent.h>
 
@@ -14,6 +15,11 @@ static void RegisterSurveillanceComponent(Schematyc::IEnvRegistrar& registrar)
 
 CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterSurveillanceComponent);
 
+namespace
+{
+	const char* const szCamSearchLabels[] = { "searching", "found", "tracking", "resetting" };
+}
+
 void CSurveillaceComponent::Initialize()
 {
 	Reset();
@@ -62,8 +68,15 @@ void CSurveillaceComponent::ProcessEvent(SEntityEvent & event)
 	case ENTITY_EVENT_UPDATE:
 		if (m_isGameMode)
 		{
+			GAME_PROFILE_SCOPE("Surveillance::Update");
 			float fFrametime = gEnv->pTimer->GetFrameTime();
 
+			GAME_DEBUG_DRAW(EDebugCategory::Surveillance, AddText3D, GetEntity()->GetWorldPos() + Vec3(0.f, 0.f, 0.5f), 1.5f, ColorF(Vec3(1, 1, 1), 0.5f), 0.1f, "%s", szCamSearchLabels[m_camSearch]);
+			if (m_pSurveillanceCameraComponent->m_foundPlayer)
+			{
+				GAME_DEBUG_DRAW(EDebugCategory::Surveillance, AddSphere, m_pSurveillanceCameraComponent->hitLocation, 0.2f, ColorF(Vec3(1, 0, 0), 0.5f), 0.1f);
+			}
+
 			if (m_camSearch == Searching)
 			{
 				Quat rot(GetEntity()->GetRotation());
@@ -88,7 +101,10 @@ void CSurveillaceComponent::ProcessEvent(SEntityEvent & event)
 				m_HitEntity = m_pSurveillanceCameraComponent->Raycast(GetEntity()->GetWorldRotation().GetColumn1(), GetEntity()->GetWorldPos(), 10.0f);
 
 				if (m_pSurveillanceCameraComponent->m_foundPlayer)
+				{
 					m_camSearch = Found;
+					m_pSurveillanceCameraComponent->ClearRay();
+				}
 			}
 			else if (m_camSearch == Found)
 			{
@@ -169,6 +185,12 @@ void CSurveillaceComponent::Reset()
 {
 	m_camSearch = Searching;
 	m_camRot = Rotate_left;
+	// Created after the first reset by Initialize
+	if (m_pSurveillanceCameraComponent != nullptr)
+	{
+		m_pSurveillanceCameraComponent->m_foundPlayer = false;
+		m_pSurveillanceCameraComponent->ClearRay();
+	}
 
 	rotator = -1;
 
@@ -176,7 +198,7 @@ void CSurveillaceComponent::Reset()
 	GetEntity()->FreeSlot(componentSlot);
 	GetEntity()->UnphysicalizeSlot(componentSlot);
 
-	GetEntity()->LoadGeometry(GetOrMakeEntitySlotId(), m_intactGeomPath.value);
+	GetEntity()->SetStatObj(CGamePlugin::GetInstance()->GetAssets().GetGeometry(m_intactGeomPath.value), componentSlot, false);
 	SEntityPhysicalizeParams params;
 	//params.type = PE_RIGID;
 	//params.mass = 10.0f;
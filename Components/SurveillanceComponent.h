@@ -52,7 +52,7 @@ public:
 	CamRotation m_camRot;
 	CamSearch m_camSearch;
 
-	CSurveillanceCameraComponent* m_pSurveillanceCameraComponent;
+	CSurveillanceCameraComponent* m_pSurveillanceCameraComponent = nullptr;
 	CFlashlightComponent* m_pFlashlightComponent;
 	IEntity* m_HitEntity;
 };
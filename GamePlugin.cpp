@@ -19,6 +19,8 @@ CGamePlugin::~CGamePlugin()
 	gEnv->pGameFramework->RemoveNetworkedClientListener(*this);
 	gEnv->pSystem->GetISystemEventDispatcher()->RemoveListener(this);
 
+	m_assets.Release();
+
 	if (gEnv->pSchematyc)
 	{
 		gEnv->pSchematyc->GetEnvRegistry().DeregisterPackage(CGamePlugin::GetCID());
@@ -31,10 +33,82 @@ bool CGamePlugin::Initialize(SSystemGlobalEnvironment& env, const SSystemInitPar
 	gEnv->pSystem->GetISystemEventDispatcher()->RegisterListener(this, "CGamePlugin");
 	// Listen for client connection events, in order to create the local player
 	gEnv->pGameFramework->AddNetworkedClientListener(*this);
+	// Receive OnPluginUpdate calls every frame, to drive game-level systems
+	SetUpdateFlags(EUpdateType_Update);
 
 	return true;
 }
 
+void CGamePlugin::OnPluginUpdate(EPluginUpdateType updateType)
+{
+	if (updateType != EUpdateType_Update)
+		return;
+
+	// A running replay applies the records of its next frame and runs it with the recorded frame time
+	const float frameTime = m_sessionReplay.BeginFrame(gEnv->pTimer->GetFrameTime());
+
+	// Everything recorded until the next frame record happened during this frame
+	CSessionRecorder::RecordFrame(frameTime);
+
+	{
+		GAME_PROFILE_SCOPE("Plugin::Update");
+
+		// Return expired bullets and stones to the pool
+		{
+			GAME_PROFILE_SCOPE("Plugin::ProjectilePool");
+			m_projectilePool.Update(frameTime);
+		}
+		{
+			GAME_PROFILE_SCOPE("Plugin::Ballistics");
+			m_ballistics.Update(frameTime);
+		}
+
+		// Players whose character became resident load it before the update
+		{
+			GAME_PROFILE_SCOPE("Plugin::CharacterStreamer");
+			m_characterStreamer.Update();
+		}
+
+		// Players submit their rays before the raycast service flushes, same as when they update themselves
+		{
+			GAME_PROFILE_SCOPE("Plugin::PlayerUpdate");
+			m_playerUpdate.Update(frameTime);
+		}
+
+		// Hand out last frame's ray results and send the rays queued since
+		{
+			GAME_PROFILE_SCOPE("Plugin::Raycasts");
+			m_raycasts.Update();
+		}
+
+#if defined(GAME_DEBUG_OVERLAY)
+		m_debugOverlay.Flush();
+#endif
+	}
+
+#if defined(GAME_PROFILER)
+	// Gameplay markers of this frame are done
+	CProfiler::OnFrameEnd();
+#endif
+}
+
+void CGamePlugin::LaunchProjectile(Projectile::EType type, const QuatTS& transform, const Vec3& velocity, EntityId shooterId)
+{
+	static ICVar* pBallistics = gEnv->pConsole->GetCVar("g_projectileBallistics");
+
+	const float mass = Projectile::GetMass(type);
+	if (pBallistics && pBallistics->GetIVal() != 0)
+	{
+		m_ballistics.Fire(transform.t, velocity, mass, shooterId);
+	}
+	else
+	{
+		m_projectilePool.Spawn(transform, velocity, mass);
+	}
+
+	CSessionRecorder::RecordProjectile(shooterId, transform.t, velocity);
+}
+
 void CGamePlugin::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lparam)
 {
 	switch (event)
@@ -77,6 +151,48 @@ void CGamePlugin::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lp
 			m_pUserSettings->RegisterCVars();
 		}
 
+		// Off by default, when set in a cfg or on the command line the log runs until shutdown or until g_eventLog is cleared
+		const ICVar* pEventLog = gEnv->pConsole->GetCVar("g_eventLog");
+		if (pEventLog != nullptr && pEventLog->GetIVal() != 0)
+		{
+			m_eventLog.Start(CEventLog::DefaultPath);
+		}
+
+		// Load the fixed assets once, components spawn from these handles afterwards
+		m_assets.Preload();
+
+	}
+	break;
+	// Fill the projectile and player pools up front so that the first shots and connections don't pay for spawning
+	case ESYSTEM_EVENT_LEVEL_LOAD_END:
+	{
+		if (!gEnv->IsEditor())
+		{
+			m_projectilePool.Prewarm();
+			// Only the server receives connections, clients get the players bound by the server
+			if (gEnv->bServer)
+			{
+				m_playerPool.Prewarm();
+			}
+		}
+	}
+	break;
+	// Pooled entities are removed together with the level
+	case ESYSTEM_EVENT_LEVEL_UNLOAD:
+	{
+		m_projectilePool.Reset();
+		m_playerPool.Reset();
+		m_characterStreamer.Reset();
+		m_ballistics.Clear();
+		m_raycasts.Reset();
+		m_sessionRecorder.Stop();
+		m_sessionReplay.Stop();
+	}
+	break;
+	// The Editor deletes the entities spawned in game mode when leaving it, pooled projectiles included
+	case ESYSTEM_EVENT_EDITOR_GAME_MODE_CHANGED:
+	{
+		m_projectilePool.Reset();
 	}
 	break;
 	}
@@ -84,6 +200,24 @@ void CGamePlugin::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lp
 
 bool CGamePlugin::OnClientConnectionReceived(int channelId, bool bIsReset)
 {
+	// Sessions are recorded from the first connection on, until the level unloads
+	const ICVar* pRecord = gEnv->pConsole->GetCVar("g_sessionRecord");
+	if (pRecord != nullptr && pRecord->GetIVal() != 0)
+	{
+		m_sessionRecorder.Start(CSessionRecorder::DefaultPath);
+	}
+
+	// Remote clients take a pooled player if one is left, the local player needs its fixed entity id
+	if (m_players.size() != 0 || gEnv->IsDedicated())
+	{
+		if (IEntity* pPlayerEntity = m_playerPool.Acquire(channelId))
+		{
+			m_players.emplace(std::make_pair(channelId, pPlayerEntity->GetId()));
+			CSessionRecorder::RecordConnect(pPlayerEntity->GetId(), channelId);
+			return true;
+		}
+	}
+
 	// Connection received from a client, create a player entity and component
 	SEntitySpawnParams spawnParams;
 	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
@@ -109,6 +243,7 @@ bool CGamePlugin::OnClientConnectionReceived(int channelId, bool bIsReset)
 
 		// Push the component into our map, with the channel id as the key
 		m_players.emplace(std::make_pair(channelId, pPlayerEntity->GetId()));
+		CSessionRecorder::RecordConnect(pPlayerEntity->GetId(), channelId);
 	}
 
 	return true;
@@ -134,11 +269,16 @@ bool CGamePlugin::OnClientReadyForGameplay(int channelId, bool bIsReset)
 
 void CGamePlugin::OnClientDisconnected(int channelId, EDisconnectionCause cause, const char* description, bool bKeepClient)
 {
-	// Client disconnected, remove the entity and from map
+	// Client disconnected, return the entity to the pool or remove it, and remove it from the map
 	auto it = m_players.find(channelId);
 	if (it != m_players.end())
 	{
-		gEnv->pEntitySystem->RemoveEntity(it->second);
+		CSessionRecorder::RecordDisconnect(it->second, channelId);
+
+		if (!m_playerPool.Release(it->second))
+		{
+			gEnv->pEntitySystem->RemoveEntity(it->second);
+		}
 
 		m_players.erase(it);
 	}
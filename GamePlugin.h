@@ -1,11 +1,26 @@
 #pragma once
 
 #include <CrySystem/ICryPlugin.h>
+#include <CrySystem/ICryPluginManager.h>
 #include <CryGame/IGameFramework.h>
 #include <CryEntitySystem/IEntityClass.h>
 #include <CryNetwork/INetwork.h>
 #include "UserSettings.h"
 #include "Components/Player.h"
+#include "Systems/ProjectilePool.h"
+#include "Systems/Ballistics.h"
+#include "Systems/ProjectileTypes.h"
+#include "Systems/CharacterStreamer.h"
+#include "Systems/DebugOverlay.h"
+#include "Systems/EventLog.h"
+#include "Systems/GameAssets.h"
+#include "Systems/PlayerPool.h"
+#include "Systems/PlayerUpdateSystem.h"
+#include "Systems/Profiler.h"
+#include "Systems/RaycastService.h"
+#include "Systems/SessionRecorder.h"
+#include "Systems/SessionReplay.h"
+#include "Systems/SpawnRegistry.h"
 
 class CPlayerComponent;
 
@@ -31,7 +46,7 @@ public:
 	virtual const char* GetName() const override { return "GamePlugin"; }
 	virtual const char* GetCategory() const override { return "Game"; }
 	virtual bool Initialize(SSystemGlobalEnvironment& env, const SSystemInitParams& initParams) override;
-	virtual void OnPluginUpdate(EPluginUpdateType updateType) override {}
+	virtual void OnPluginUpdate(EPluginUpdateType updateType) override;
 	// ~ICryPlugin
 
 	// ISystemEventListener
@@ -55,10 +70,58 @@ public:
 	virtual bool OnClientTimingOut(int channelId, EDisconnectionCause cause, const char* description) override { return true; }
 	// ~INetworkedClientListener
 
+	// Helper to retrieve the plug-in instance from game code, e.g. components
+	static CGamePlugin* GetInstance() { return gEnv->pSystem->GetIPluginManager()->QueryPlugin<CGamePlugin>(); }
+
+	CProjectilePool& GetProjectilePool() { return m_projectilePool; }
+	CBallisticsSystem& GetBallistics() { return m_ballistics; }
+	CGameAssets& GetAssets() { return m_assets; }
+	CRaycastService& GetRaycasts() { return m_raycasts; }
+#if defined(GAME_DEBUG_OVERLAY)
+	CDebugOverlay& GetDebugOverlay() { return m_debugOverlay; }
+#endif
+	CEventLog& GetEventLog() { return m_eventLog; }
+	CSpawnRegistry& GetSpawnRegistry() { return m_spawnRegistry; }
+	CPlayerUpdateSystem& GetPlayerUpdate() { return m_playerUpdate; }
+	CPlayerPool& GetPlayerPool() { return m_playerPool; }
+	CCharacterStreamer& GetCharacterStreamer() { return m_characterStreamer; }
+	CSessionRecorder& GetSessionRecorder() { return m_sessionRecorder; }
+	CSessionReplay& GetSessionReplay() { return m_sessionReplay; }
+
+	// Launches a bullet or stone, either as a pooled rigid body or as an analytic projectile depending on g_projectileBallistics
+	// Velocity in m/s in both cases
+	void LaunchProjectile(Projectile::EType type, const QuatTS& transform, const Vec3& velocity, EntityId shooterId);
 
 	// Map containing player components, key is the channel id received in OnClientConnectionReceived
 	std::unordered_map<int, EntityId> m_players;
-	CUserSettings* m_pUserSettings;
-	CPlayerComponent* m_pPlayer;
+	CUserSettings* m_pUserSettings = nullptr;
+	// Geometry, materials and textures used by our components, kept resident from POST_INIT on
+	CGameAssets m_assets;
+	CPlayerComponent* m_pPlayer = nullptr;
+
+	// Bullets and thrown stones, pre-spawned so that shooting doesn't spawn entities
+	CProjectilePool m_projectilePool;
+	// Projectiles simulated without entities, see g_projectileBallistics
+	CBallisticsSystem m_ballistics;
+	// Gameplay rays, batched per frame and answered the frame after
+	CRaycastService m_raycasts;
+#if defined(GAME_DEBUG_OVERLAY)
+	// Gameplay debug primitives, see GAME_DEBUG_DRAW
+	CDebugOverlay m_debugOverlay;
+#endif
+	// Binary gameplay events, written through CEventLog::Write while g_eventLog is set
+	CEventLog m_eventLog;
+	// Spawn points of the loaded level, see g_spawnPolicy
+	CSpawnRegistry m_spawnRegistry;
+	// Batched player simulation, see g_playerBatchUpdate
+	CPlayerUpdateSystem m_playerUpdate;
+	// Hidden players spawned on level load for connecting clients, see g_playerPoolSize
+	CPlayerPool m_playerPool;
+	// Player character files read in the background, see g_playerStreamedLoad
+	CCharacterStreamer m_characterStreamer;
+	// Inputs, frame times, spawns and collisions of the session, see g_sessionRecord
+	CSessionRecorder m_sessionRecorder;
+	// Recorded sessions played back through the game, see g_sessionReplay
+	CSessionReplay m_sessionReplay;
 };
 
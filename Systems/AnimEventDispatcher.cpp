@@ -0,0 +1,46 @@
+#include "StdAfx.h"
+#include "AnimEventDispatcher.h"
+
+#include <CrySystem/IConsole.h>
+
+std::vector<CAnimEventStatistics::SEntry> CAnimEventStatistics::s_entries;
+
+void CAnimEventStatistics::Record(const AnimEventInstance& event, bool bHandled)
+{
+	for (SEntry& entry : s_entries)
+	{
+		if (entry.nameCrc == event.m_EventNameLowercaseCRC32)
+		{
+			++(bHandled ? entry.handled : entry.unhandled);
+			return;
+		}
+	}
+
+	// First time the event is seen, keep its name for the report
+	SEntry entry;
+	entry.nameCrc = event.m_EventNameLowercaseCRC32;
+	entry.name = event.m_EventName != nullptr ? event.m_EventName : "";
+	entry.handled = bHandled ? 1 : 0;
+	entry.unhandled = bHandled ? 0 : 1;
+	s_entries.push_back(entry);
+}
+
+void CAnimEventStatistics::LogStatistics(IConsoleCmdArgs* pArgs)
+{
+	uint32 handled = 0;
+	uint32 unhandled = 0;
+	for (const SEntry& entry : s_entries)
+	{
+		handled += entry.handled;
+		unhandled += entry.unhandled;
+	}
+
+	CryLogAlways("Anim events: %u handled, %u unhandled since the last call", handled, unhandled);
+	for (const SEntry& entry : s_entries)
+	{
+		CryLogAlways("    %-24s crc 0x%08x: %u handled, %u unhandled%s", entry.name.c_str(), entry.nameCrc, entry.handled, entry.unhandled,
+			entry.handled == 0 ? " (nobody consumes this event)" : "");
+	}
+
+	s_entries.clear();
+}
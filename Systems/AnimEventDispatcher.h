@@ -0,0 +1,120 @@
+#pragma once
+
+#include <CryAnimation/ICryAnimation.h>
+
+#include <initializer_list>
+#include <vector>
+
+struct IConsoleCmdArgs;
+
+namespace AnimEventHash
+{
+	constexpr char ToLower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	// Matches CCrc32::ComputeLowercase, which fills AnimEventInstance::m_EventNameLowercaseCRC32
+	constexpr uint32 Crc32Lowercase(const char* szName)
+	{
+		uint32 crc = 0xFFFFFFFF;
+		for (const char* szCursor = szName; *szCursor != '\0'; ++szCursor)
+		{
+			crc ^= static_cast<uint8>(ToLower(*szCursor));
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+			}
+		}
+		return ~crc;
+	}
+
+	static_assert(Crc32Lowercase("") == 0, "Unexpected CRC32 of an empty name");
+	static_assert(Crc32Lowercase("123456789") == 0xCBF43926, "Unexpected CRC32 check value");
+	static_assert(Crc32Lowercase("Throw") == Crc32Lowercase("throw"), "Anim event names are hashed case insensitive");
+}
+
+////////////////////////////////////////////////////////
+// Counts dispatched anim events per name, shared by all dispatchers
+// Unhandled events are emitted by the animations but consumed by nobody, see g_animEventStats
+////////////////////////////////////////////////////////
+class CAnimEventStatistics
+{
+public:
+	static void Record(const AnimEventInstance& event, bool bHandled);
+	static void LogStatistics(IConsoleCmdArgs* pArgs);
+
+protected:
+	struct SEntry
+	{
+		uint32 nameCrc;
+		string name;
+		uint32 handled;
+		uint32 unhandled;
+	};
+
+	// Only a handful of distinct events, searched linearly
+	static std::vector<SEntry> s_entries;
+};
+
+////////////////////////////////////////////////////////
+// Maps anim events to member function handlers of a component by the CRC32 of their name
+// Built once per component type, dispatching compares the precomputed CRC of the event instead of its name
+////////////////////////////////////////////////////////
+template<typename TOwner>
+class CAnimEventDispatcher
+{
+public:
+	typedef void (TOwner::*THandler)(const AnimEventInstance& event);
+
+	struct SHandler
+	{
+		constexpr SHandler(const char* szName, THandler handler)
+			: szName(szName), nameCrc(AnimEventHash::Crc32Lowercase(szName)), handler(handler) {}
+
+		const char* szName;
+		uint32 nameCrc;
+		THandler handler;
+	};
+
+	static const uint32 MaxHandlers = 8;
+
+public:
+	// Usually constructed during static initialization, handlers past MaxHandlers are ignored
+	CAnimEventDispatcher(std::initializer_list<SHandler> handlers)
+	{
+		for (const SHandler& handler : handlers)
+		{
+			if (m_count < MaxHandlers)
+			{
+				m_nameCrcs[m_count] = handler.nameCrc;
+				m_handlers[m_count] = handler.handler;
+				++m_count;
+			}
+		}
+	}
+
+	// Returns false if no handler is registered for the event
+	bool Dispatch(TOwner& owner, const AnimEventInstance& event) const
+	{
+		const uint32 nameCrc = event.m_EventNameLowercaseCRC32;
+		for (uint32 i = 0; i < m_count; ++i)
+		{
+			if (m_nameCrcs[i] == nameCrc)
+			{
+				(owner.*m_handlers[i])(event);
+				CAnimEventStatistics::Record(event, true);
+				return true;
+			}
+		}
+
+		CAnimEventStatistics::Record(event, false);
+		return false;
+	}
+
+protected:
+	// Kept apart from the handlers so that the search only touches the CRCs
+	uint32 m_nameCrcs[MaxHandlers];
+	THandler m_handlers[MaxHandlers];
+	uint32 m_count = 0;
+};
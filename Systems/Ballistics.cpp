@@ -0,0 +1,364 @@
+#include "StdAfx.h"
+#include "Ballistics.h"
+#include "ProjectileTypes.h"
+#include "SessionRecorder.h"
+
+#include "../Components/DestroyableComponent.h"
+
+#include <CrySystem/IConsole.h>
+#include <CryGame/IGameFramework.h>
+#include <IMaterialEffects.h>
+
+#if CRY_PLATFORM_SSE2
+	#include <xmmintrin.h>
+#endif
+
+void CBallisticsSystem::SProjectileBuffer::Resize(uint32 size)
+{
+	// Keep a multiple of four so that the SIMD kernel never reads past the end
+	size = (size + 3) & ~3u;
+
+	for (std::vector<float>* pArray : { &posX, &posY, &posZ, &velX, &velY, &velZ, &startX, &startY, &startZ, &gravity, &drag, &age, &mass })
+	{
+		pArray->resize(size);
+	}
+	skipEntity.resize(size);
+}
+
+void CBallisticsSystem::Fire(const Vec3& position, const Vec3& velocity, float mass, EntityId skipEntityId, float gravity, float drag)
+{
+	if (m_count >= m_buffer.age.size())
+	{
+		m_buffer.Resize(max(m_count * 2, 64u));
+	}
+
+	const uint32 index = m_count++;
+
+	m_buffer.posX[index] = position.x;
+	m_buffer.posY[index] = position.y;
+	m_buffer.posZ[index] = position.z;
+	m_buffer.velX[index] = velocity.x;
+	m_buffer.velY[index] = velocity.y;
+	m_buffer.velZ[index] = velocity.z;
+	m_buffer.gravity[index] = gravity;
+	m_buffer.drag[index] = drag;
+	m_buffer.age[index] = 0.f;
+	m_buffer.mass[index] = mass;
+	m_buffer.skipEntity[index] = skipEntityId;
+}
+
+void CBallisticsSystem::Update(float frameTime)
+{
+	if (m_count == 0 || frameTime <= 0.f)
+	{
+		m_statistics.raysLastFrame = 0;
+		return;
+	}
+
+	static ICVar* pMaxAge = gEnv->pConsole->GetCVar("g_projectileMaxAge");
+	const float maxAge = pMaxAge ? pMaxAge->GetFVal() : 5.f;
+
+	const CTimeValue integrateStart = gEnv->pTimer->GetAsyncTime();
+
+	Integrate(m_buffer, m_count, frameTime);
+
+	const CTimeValue sweepStart = gEnv->pTimer->GetAsyncTime();
+
+	uint32 rayCount = 0;
+
+	// Walk backwards so that removing by swapping with the last projectile doesn't skip any
+	for (uint32 i = m_count; i-- > 0;)
+	{
+		if (m_buffer.age[i] > maxAge)
+		{
+			++m_statistics.expired;
+			Remove(i);
+			continue;
+		}
+
+		const Vec3 start(m_buffer.startX[i], m_buffer.startY[i], m_buffer.startZ[i]);
+		const Vec3 end(m_buffer.posX[i], m_buffer.posY[i], m_buffer.posZ[i]);
+
+		IPhysicalEntity* pSkipEntity = nullptr;
+		if (IEntity* pEntity = gEnv->pEntitySystem->GetEntity(m_buffer.skipEntity[i]))
+		{
+			pSkipEntity = pEntity->GetPhysics();
+		}
+
+		ray_hit hit;
+		const int hits = gEnv->pPhysicalWorld->RayWorldIntersection(start, end - start, ent_all, rwi_stop_at_pierceable | rwi_colltype_any, &hit, 1, &pSkipEntity, pSkipEntity ? 1 : 0);
+		++rayCount;
+
+		if (hits > 0 && hit.pCollider)
+		{
+			OnImpact(i, hit);
+			Remove(i);
+		}
+	}
+
+	const CTimeValue sweepEnd = gEnv->pTimer->GetAsyncTime();
+
+	m_statistics.raysLastFrame = rayCount;
+	m_statistics.integrateTimeMs = (sweepStart - integrateStart).GetMilliSeconds();
+	m_statistics.sweepTimeMs = (sweepEnd - sweepStart).GetMilliSeconds();
+}
+
+void CBallisticsSystem::LogStatistics() const
+{
+	CryLogAlways("Ballistics: %u in flight, %u rays last frame, %u impacts, %u expired", m_count, m_statistics.raysLastFrame, m_statistics.impacts, m_statistics.expired);
+	CryLogAlways("    integrate %.3f ms, sweep %.3f ms", m_statistics.integrateTimeMs, m_statistics.sweepTimeMs);
+}
+
+void CBallisticsSystem::Integrate(SProjectileBuffer& buffer, uint32 count, float dt)
+{
+	float* __restrict posX = buffer.posX.data();
+	float* __restrict posY = buffer.posY.data();
+	float* __restrict posZ = buffer.posZ.data();
+	float* __restrict velX = buffer.velX.data();
+	float* __restrict velY = buffer.velY.data();
+	float* __restrict velZ = buffer.velZ.data();
+	float* __restrict startX = buffer.startX.data();
+	float* __restrict startY = buffer.startY.data();
+	float* __restrict startZ = buffer.startZ.data();
+	float* __restrict age = buffer.age.data();
+	const float* __restrict gravity = buffer.gravity.data();
+	const float* __restrict drag = buffer.drag.data();
+
+	uint32 i = 0;
+
+#if CRY_PLATFORM_SSE2
+	const __m128 dt4 = _mm_set1_ps(dt);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(posX + i);
+		__m128 py = _mm_loadu_ps(posY + i);
+		__m128 pz = _mm_loadu_ps(posZ + i);
+		__m128 vx = _mm_loadu_ps(velX + i);
+		__m128 vy = _mm_loadu_ps(velY + i);
+		__m128 vz = _mm_loadu_ps(velZ + i);
+
+		// Remember where this step starts for the swept ray
+		_mm_storeu_ps(startX + i, px);
+		_mm_storeu_ps(startY + i, py);
+		_mm_storeu_ps(startZ + i, pz);
+
+		// Quadratic drag, opposing the velocity and scaled by speed
+		const __m128 speed = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+		const __m128 dragFactor = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(drag + i), speed), dt4);
+
+		vx = _mm_sub_ps(vx, _mm_mul_ps(vx, dragFactor));
+		vy = _mm_sub_ps(vy, _mm_mul_ps(vy, dragFactor));
+		vz = _mm_sub_ps(vz, _mm_add_ps(_mm_mul_ps(vz, dragFactor), _mm_mul_ps(_mm_loadu_ps(gravity + i), dt4)));
+
+		px = _mm_add_ps(px, _mm_mul_ps(vx, dt4));
+		py = _mm_add_ps(py, _mm_mul_ps(vy, dt4));
+		pz = _mm_add_ps(pz, _mm_mul_ps(vz, dt4));
+
+		_mm_storeu_ps(posX + i, px);
+		_mm_storeu_ps(posY + i, py);
+		_mm_storeu_ps(posZ + i, pz);
+		_mm_storeu_ps(velX + i, vx);
+		_mm_storeu_ps(velY + i, vy);
+		_mm_storeu_ps(velZ + i, vz);
+		_mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt4));
+	}
+#endif
+
+	// Remainder, or everything on platforms without SSE
+	for (; i < count; ++i)
+	{
+		startX[i] = posX[i];
+		startY[i] = posY[i];
+		startZ[i] = posZ[i];
+
+		const float speed = sqrtf(velX[i] * velX[i] + velY[i] * velY[i] + velZ[i] * velZ[i]);
+		const float dragFactor = drag[i] * speed * dt;
+
+		velX[i] -= velX[i] * dragFactor;
+		velY[i] -= velY[i] * dragFactor;
+		velZ[i] -= velZ[i] * dragFactor + gravity[i] * dt;
+
+		posX[i] += velX[i] * dt;
+		posY[i] += velY[i] * dt;
+		posZ[i] += velZ[i] * dt;
+
+		age[i] += dt;
+	}
+}
+
+void CBallisticsSystem::Remove(uint32 index)
+{
+	const uint32 last = --m_count;
+	if (index == last)
+		return;
+
+	SProjectileBuffer& b = m_buffer;
+	b.posX[index] = b.posX[last];
+	b.posY[index] = b.posY[last];
+	b.posZ[index] = b.posZ[last];
+	b.velX[index] = b.velX[last];
+	b.velY[index] = b.velY[last];
+	b.velZ[index] = b.velZ[last];
+	b.startX[index] = b.startX[last];
+	b.startY[index] = b.startY[last];
+	b.startZ[index] = b.startZ[last];
+	b.gravity[index] = b.gravity[last];
+	b.drag[index] = b.drag[last];
+	b.age[index] = b.age[last];
+	b.mass[index] = b.mass[last];
+	b.skipEntity[index] = b.skipEntity[last];
+}
+
+void CBallisticsSystem::OnImpact(uint32 index, const ray_hit& hit)
+{
+	++m_statistics.impacts;
+
+	const Vec3 velocity(m_buffer.velX[index], m_buffer.velY[index], m_buffer.velZ[index]);
+	const float mass = m_buffer.mass[index];
+
+	// Push whatever was hit, the same way a rigid projectile would
+	pe_action_impulse impulseAction;
+	impulseAction.point = hit.pt;
+	impulseAction.impulse = velocity * mass;
+	hit.pCollider->Action(&impulseAction);
+
+	IEntity* pHitEntity = gEnv->pEntitySystem->GetEntityFromPhysics(hit.pCollider);
+	CSessionRecorder::RecordCollision(pHitEntity != nullptr ? pHitEntity->GetId() : INVALID_ENTITYID, hit.pt, mass);
+
+	if (pHitEntity != nullptr)
+	{
+		if (CDestroyableComponent* pDestroyable = pHitEntity->GetComponent<CDestroyableComponent>())
+		{
+			pDestroyable->DecrementLife(mass);
+		}
+	}
+
+	// Play the bullet impact effect set up in Libs/MaterialEffects
+	if (IMaterialEffects* pMaterialEffects = gEnv->pGameFramework->GetIMaterialEffects())
+	{
+		if (m_bulletSurfaceId < 0)
+		{
+			m_bulletSurfaceId = gEnv->p3DEngine->GetMaterialManager()->GetSurfaceTypeIdByName("mat_bullet");
+		}
+
+		const TMFXEffectId effectId = pMaterialEffects->GetEffectId(m_bulletSurfaceId, hit.surface_idx);
+		if (effectId != InvalidEffectId)
+		{
+			SMFXRunTimeEffectParams effectParams;
+			effectParams.pos = hit.pt;
+			effectParams.normal = hit.n;
+			effectParams.dir[0] = velocity.GetNormalizedSafe();
+			pMaterialEffects->ExecuteEffect(effectId, effectParams);
+		}
+	}
+}
+
+void CBallisticsSystem::RunBenchmark(IConsoleCmdArgs* pArgs)
+{
+	const int steps = pArgs->GetArgCount() > 1 ? max(atoi(pArgs->GetArg(1)), 1) : 60;
+	const float dt = 1.f / 60.f;
+
+	// Run far above the level so that neither rays nor rigid bodies hit level geometry
+	const Vec3 origin(0.f, 0.f, 20000.f);
+	const float spacing = 2.f;
+
+	static const uint32 projectileCounts[] = { 1000, 10000, 100000 };
+
+	CryLogAlways("Ballistics benchmark, %d steps of %.4f s", steps, dt);
+
+	for (const uint32 count : projectileCounts)
+	{
+		const uint32 rowLength = (uint32)sqrtf((float)count) + 1;
+		auto getPosition = [&](uint32 i) { return origin + Vec3((i % rowLength) * spacing, (i / rowLength) * spacing, 0.f); };
+
+		// Analytic path, kernel only
+		SProjectileBuffer buffer;
+		buffer.Resize(count);
+		for (uint32 i = 0; i < count; ++i)
+		{
+			const Vec3 position = getPosition(i);
+			buffer.posX[i] = position.x;
+			buffer.posY[i] = position.y;
+			buffer.posZ[i] = position.z;
+			buffer.velX[i] = 0.f;
+			buffer.velY[i] = 300.f;
+			buffer.velZ[i] = 0.f;
+			buffer.gravity[i] = 9.81f;
+			buffer.drag[i] = 0.01f;
+			buffer.age[i] = 0.f;
+		}
+
+		CTimeValue start = gEnv->pTimer->GetAsyncTime();
+		for (int step = 0; step < steps; ++step)
+		{
+			Integrate(buffer, count, dt);
+		}
+		const float kernelMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+
+		// Analytic path including one swept ray per projectile per step
+		start = gEnv->pTimer->GetAsyncTime();
+		for (int step = 0; step < steps; ++step)
+		{
+			Integrate(buffer, count, dt);
+			for (uint32 i = 0; i < count; ++i)
+			{
+				const Vec3 rayStart(buffer.startX[i], buffer.startY[i], buffer.startZ[i]);
+				const Vec3 rayEnd(buffer.posX[i], buffer.posY[i], buffer.posZ[i]);
+
+				ray_hit hit;
+				gEnv->pPhysicalWorld->RayWorldIntersection(rayStart, rayEnd - rayStart, ent_all, rwi_stop_at_pierceable | rwi_colltype_any, &hit, 1);
+			}
+		}
+		const float sweepMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+
+		// Rigid body path, the same projectiles as PE_RIGID spheres stepped by the physics world
+		IGeomManager* pGeomManager = gEnv->pPhysicalWorld->GetGeomManager();
+
+		primitives::sphere sphere;
+		sphere.center.zero();
+		sphere.r = 0.05f;
+		IGeometry* pGeometry = pGeomManager->CreatePrimitive(primitives::sphere::type, &sphere);
+		phys_geometry* pPhysGeometry = pGeomManager->RegisterGeometry(pGeometry);
+		pGeometry->Release();
+
+		pe_geomparams geomParams;
+		geomParams.mass = Projectile::GetMass(Projectile::EType::Bullet);
+
+		std::vector<IPhysicalEntity*> rigidBodies;
+		rigidBodies.reserve(count);
+
+		start = gEnv->pTimer->GetAsyncTime();
+		for (uint32 i = 0; i < count; ++i)
+		{
+			pe_params_pos posParams;
+			posParams.pos = getPosition(i);
+
+			IPhysicalEntity* pRigidBody = gEnv->pPhysicalWorld->CreatePhysicalEntity(PE_RIGID, &posParams);
+			pRigidBody->AddGeometry(pPhysGeometry, &geomParams);
+
+			pe_action_set_velocity velocityAction;
+			velocityAction.v = Vec3(0.f, 300.f, 0.f);
+			pRigidBody->Action(&velocityAction);
+
+			rigidBodies.push_back(pRigidBody);
+		}
+		const float rigidCreateMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+
+		start = gEnv->pTimer->GetAsyncTime();
+		for (int step = 0; step < steps; ++step)
+		{
+			gEnv->pPhysicalWorld->TimeStep(dt);
+		}
+		const float rigidStepMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+
+		for (IPhysicalEntity* pRigidBody : rigidBodies)
+		{
+			gEnv->pPhysicalWorld->DestroyPhysicalEntity(pRigidBody);
+		}
+		pGeomManager->UnregisterGeometry(pPhysGeometry);
+
+		CryLogAlways("    %6u projectiles: kernel %.3f ms/step, kernel + rays %.3f ms/step, rigid bodies %.3f ms/step (+ %.3f ms to create)",
+			count, kernelMs / steps, sweepMs / steps, rigidStepMs / steps, rigidCreateMs);
+	}
+}
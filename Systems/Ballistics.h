@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include <CryEntitySystem/IEntitySystem.h>
+
+////////////////////////////////////////////////////////
+// Analytic projectile simulation, used instead of pooled rigid bodies when g_projectileBallistics is set
+// Projectiles are kept in a structure-of-arrays buffer and integrated with a SIMD kernel,
+// each step issues one swept ray per projectile and only impacts result in physics actions and effects
+////////////////////////////////////////////////////////
+class CBallisticsSystem
+{
+public:
+	// Structure-of-arrays storage for projectiles in flight
+	struct SProjectileBuffer
+	{
+		void Resize(uint32 size);
+
+		std::vector<float> posX, posY, posZ;
+		std::vector<float> velX, velY, velZ;
+		// Position at the start of the last step, origin of the swept ray
+		std::vector<float> startX, startY, startZ;
+		std::vector<float> gravity;
+		std::vector<float> drag;
+		std::vector<float> age;
+		// Mass in kg of the projectile type, for impact impulses and damage
+		std::vector<float> mass;
+		// Entity excluded from the swept ray, normally the shooter
+		std::vector<EntityId> skipEntity;
+	};
+
+	struct SStatistics
+	{
+		uint32 raysLastFrame = 0;
+		uint32 impacts = 0;
+		uint32 expired = 0;
+		float integrateTimeMs = 0.f;
+		float sweepTimeMs = 0.f;
+	};
+
+public:
+	// Adds a projectile in flight, velocity in m/s, mass in kg and drag as a quadratic coefficient
+	void Fire(const Vec3& position, const Vec3& velocity, float mass, EntityId skipEntityId, float gravity = 9.81f, float drag = 0.01f);
+	void Clear() { m_count = 0; }
+
+	// Integrates all projectiles, sweeps them against the world and resolves impacts
+	void Update(float frameTime);
+
+	uint32 GetCount() const { return m_count; }
+	const SStatistics& GetStatistics() const { return m_statistics; }
+
+	void LogStatistics() const;
+
+	// Advances count projectiles in the buffer by dt, semi-implicit Euler with gravity and quadratic drag
+	static void Integrate(SProjectileBuffer& buffer, uint32 count, float dt);
+
+	// Console command comparing the analytic path against rigid bodies for 1k, 10k and 100k projectiles
+	static void RunBenchmark(IConsoleCmdArgs* pArgs);
+
+protected:
+	void Remove(uint32 index);
+	void OnImpact(uint32 index, const ray_hit& hit);
+
+protected:
+	SProjectileBuffer m_buffer;
+	uint32 m_count = 0;
+
+	int m_bulletSurfaceId = -1;
+
+	SStatistics m_statistics;
+};
@@ -0,0 +1,200 @@
+#include "StdAfx.h"
+#include "CharacterStreamer.h"
+
+#include <CryAnimation/ICryAnimation.h>
+
+#include <algorithm>
+
+void CCharacterStreamer::Request(const void* pOwner, const char* szCharacterFile, const char* szDatabaseFile, const char* szControllerDefinitionFile, TCallback onReady)
+{
+	Cancel(pOwner);
+
+	SRequest request;
+	request.id = ++m_nextId;
+	request.pOwner = pOwner;
+	request.onReady = std::move(onReady);
+	request.startTime = gEnv->pTimer->GetAsyncTime();
+	request.characterFile = szCharacterFile;
+
+	// Skeleton and skins of the character definition, streamed by the character manager itself
+	if (gEnv->pCharacterManager != nullptr && !request.characterFile.empty())
+	{
+		gEnv->pCharacterManager->StreamKeepCharacterResident(szCharacterFile, 0, 1, true);
+		request.bResident = true;
+	}
+
+	m_requests.push_back(std::move(request));
+
+	++m_statistics.requests;
+
+	// Hold one pending file ourselves, so that reads completing right away can't finish the request early
+	const uint32 id = m_nextId;
+	++m_requests.back().pending;
+
+	StartRead(id, szDatabaseFile);
+	StartRead(id, szControllerDefinitionFile);
+
+	FinishFile(id);
+}
+
+void CCharacterStreamer::Cancel(const void* pOwner)
+{
+	auto it = std::find_if(m_requests.begin(), m_requests.end(), [pOwner](const SRequest& request) { return request.pOwner == pOwner; });
+	if (it == m_requests.end())
+		return;
+
+	// Aborted streams may still call back, they won't find their request anymore
+	SRequest request = std::move(*it);
+	m_requests.erase(it);
+
+	for (IReadStreamPtr& pStream : request.streams)
+	{
+		pStream->Abort();
+	}
+	ReleaseResident(request);
+}
+
+void CCharacterStreamer::Reset()
+{
+	while (!m_requests.empty())
+	{
+		Cancel(m_requests.back().pOwner);
+	}
+}
+
+void CCharacterStreamer::Update()
+{
+	for (size_t i = 0; i < m_requests.size();)
+	{
+		// A completed request is erased, the next one moves into its place
+		if (m_requests[i].pending > 0 || !TryComplete(m_requests[i].id))
+		{
+			++i;
+		}
+	}
+}
+
+void CCharacterStreamer::RecordControllable(bool bStreamed, float timeMs)
+{
+	SStatistics::SControllable& controllable = m_statistics.controllable[bStreamed ? 1 : 0];
+	++controllable.count;
+	controllable.totalMs += timeMs;
+	controllable.maxMs = max(controllable.maxMs, timeMs);
+}
+
+void CCharacterStreamer::LogStatistics()
+{
+	CryLogAlways("Character streamer: %u requests, %" PRISIZE_T " in flight, %u files read (%.1f KB), %u failed",
+		m_statistics.requests, m_requests.size(), m_statistics.files, m_statistics.bytes / 1024.f, m_statistics.failedFiles);
+	CryLogAlways("    streaming %.1f ms per request, max %.1f ms, %u requests waited for resident character resources",
+		m_statistics.streamTimeMs / max(m_statistics.requests, 1u), m_statistics.maxStreamTimeMs, m_statistics.residentWaits);
+
+	static const char* szModeNames[] = { "synchronous", "streamed" };
+	for (int i = 0; i < 2; ++i)
+	{
+		const SStatistics::SControllable& controllable = m_statistics.controllable[i];
+		CryLogAlways("    %s load: %u players, first controllable frame after %.1f ms on average, max %.1f ms",
+			szModeNames[i], controllable.count, controllable.totalMs / max(controllable.count, 1u), controllable.maxMs);
+	}
+
+	m_statistics = SStatistics();
+}
+
+void CCharacterStreamer::StreamOnComplete(IReadStream* pStream, unsigned nError)
+{
+	const uint32 id = static_cast<uint32>(pStream->GetUserData());
+	if (Find(id) == nullptr)
+		return;
+
+	if (nError != 0)
+	{
+		// The synchronous load afterwards reports the actual problem
+		++m_statistics.failedFiles;
+	}
+	else
+	{
+		++m_statistics.files;
+		m_statistics.bytes += pStream->GetBytesRead();
+	}
+
+	FinishFile(id);
+}
+
+CCharacterStreamer::SRequest* CCharacterStreamer::Find(uint32 id)
+{
+	auto it = std::find_if(m_requests.begin(), m_requests.end(), [id](const SRequest& request) { return request.id == id; });
+	return it != m_requests.end() ? &*it : nullptr;
+}
+
+void CCharacterStreamer::StartRead(uint32 id, const char* szFile)
+{
+	if (szFile == nullptr || szFile[0] == '\0')
+		return;
+
+	SRequest* pRequest = Find(id);
+	if (pRequest == nullptr)
+		return;
+
+	++pRequest->pending;
+
+	StreamReadParams params;
+	params.dwUserData = id;
+	params.ePriority = estpNormal;
+
+	IReadStreamPtr pStream = gEnv->pSystem->GetStreamEngine()->StartRead(eStreamTaskTypeAnimation, szFile, this, &params);
+	if (pStream == nullptr)
+	{
+		++m_statistics.failedFiles;
+		FinishFile(id);
+		return;
+	}
+
+	// The request may already be gone if the read completed synchronously
+	if ((pRequest = Find(id)) != nullptr)
+	{
+		pRequest->streams.push_back(pStream);
+	}
+}
+
+void CCharacterStreamer::FinishFile(uint32 id)
+{
+	SRequest* pRequest = Find(id);
+	if (pRequest == nullptr || --pRequest->pending > 0)
+		return;
+
+	if (!TryComplete(id))
+	{
+		++m_statistics.residentWaits;
+	}
+}
+
+bool CCharacterStreamer::TryComplete(uint32 id)
+{
+	auto it = std::find_if(m_requests.begin(), m_requests.end(), [id](const SRequest& request) { return request.id == id; });
+	if (it == m_requests.end())
+		return false;
+
+	if (it->bResident && !gEnv->pCharacterManager->StreamHasCharacterResources(it->characterFile.c_str(), 0))
+		return false;
+
+	const float streamTimeMs = (gEnv->pTimer->GetAsyncTime() - it->startTime).GetMilliSeconds();
+	m_statistics.streamTimeMs += streamTimeMs;
+	m_statistics.maxStreamTimeMs = max(m_statistics.maxStreamTimeMs, streamTimeMs);
+
+	// The owner may request again from its callback, the resources stay resident until it created its instance
+	SRequest request = std::move(*it);
+	m_requests.erase(it);
+
+	request.onReady();
+	ReleaseResident(request);
+	return true;
+}
+
+void CCharacterStreamer::ReleaseResident(SRequest& request)
+{
+	if (request.bResident && gEnv->pCharacterManager != nullptr)
+	{
+		gEnv->pCharacterManager->StreamKeepCharacterResident(request.characterFile.c_str(), 0, -1, false);
+		request.bResident = false;
+	}
+}
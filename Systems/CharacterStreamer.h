@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <CrySystem/IStreamEngine.h>
+
+////////////////////////////////////////////////////////
+// Gets the files of a player character ready before it is loaded on the main thread
+// The skeleton and skins of the character definition are streamed in by the character manager and kept resident until the
+// owner has created its instance, so creating it doesn't load geometry. The small Mannequin database and controller definition
+// are read through the stream engine ahead, the Mannequin loaders still parse them from the pak afterwards
+// The owner is called back on the main thread once the files are read and the character resources are resident
+////////////////////////////////////////////////////////
+class CCharacterStreamer final : public IStreamCallback
+{
+public:
+	typedef std::function<void()> TCallback;
+
+	struct SStatistics
+	{
+		uint32 requests = 0;
+		uint32 files = 0;
+		uint32 failedFiles = 0;
+		uint64 bytes = 0;
+		// Requests that had their files read and still waited for the character manager
+		uint32 residentWaits = 0;
+		// From the request until the last file was read
+		float streamTimeMs = 0.f;
+		float maxStreamTimeMs = 0.f;
+
+		// From spawning or leaving the player pool until the first frame the player could be controlled
+		// Indexed by whether the assets were streamed
+		struct SControllable
+		{
+			uint32 count = 0;
+			float totalMs = 0.f;
+			float maxMs = 0.f;
+		};
+		SControllable controllable[2];
+	};
+
+public:
+	CCharacterStreamer() = default;
+	virtual ~CCharacterStreamer() { Reset(); }
+
+	// Starts reading the files, replaces a pending request of the same owner
+	// onReady is called on the main thread once all files are read or failed and the character resources are resident
+	void Request(const void* pOwner, const char* szCharacterFile, const char* szDatabaseFile, const char* szControllerDefinitionFile, TCallback onReady);
+	// Drops the request of the owner without calling it back
+	void Cancel(const void* pOwner);
+	void Reset();
+
+	// Calls back the requests whose character resources became resident, once per frame
+	void Update();
+
+	void RecordControllable(bool bStreamed, float timeMs);
+
+	void LogStatistics();
+
+	// IStreamCallback
+	virtual void StreamOnComplete(IReadStream* pStream, unsigned nError) override;
+	// ~IStreamCallback
+
+protected:
+	struct SRequest
+	{
+		uint32 id;
+		const void* pOwner;
+		TCallback onReady;
+		// Files started and not yet completed
+		uint32 pending = 0;
+		std::vector<IReadStreamPtr> streams;
+		CTimeValue startTime;
+		// Held resident in the character manager until the owner was called back
+		string characterFile;
+		bool bResident = false;
+	};
+
+	SRequest* Find(uint32 id);
+	void StartRead(uint32 id, const char* szFile);
+	void FinishFile(uint32 id);
+	// Calls the owner back if the files are read and the character resources are resident
+	bool TryComplete(uint32 id);
+	static void ReleaseResident(SRequest& request);
+
+protected:
+	// Only a handful of players load at once
+	std::vector<SRequest> m_requests;
+	uint32 m_nextId = 0;
+
+	SStatistics m_statistics;
+};
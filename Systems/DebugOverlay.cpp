@@ -0,0 +1,189 @@
+#include "StdAfx.h"
+#include "DebugOverlay.h"
+
+#include <CrySystem/IConsole.h>
+#include <CryGame/IGameFramework.h>
+
+#if defined(GAME_DEBUG_OVERLAY)
+
+namespace
+{
+	struct SCategoryDesc
+	{
+		const char* szCVarName;
+		// Persistent debug group the primitives are added to
+		const char* szGroupName;
+		const char* szHelp;
+	};
+
+	const SCategoryDesc categoryDescs[] =
+	{
+		{ "g_debugState", "PlayerState", "Draws the player state, crouch and movement flags" },
+		{ "g_debugCamera", "PlayerCamera", "Draws the third person camera boom hits" },
+		{ "g_debugHeadroom", "PlayerHeadroom", "Draws the headroom ray and whether the player can stand up" },
+		{ "g_debugInteraction", "PlayerInteraction", "Draws the entity under the crosshair" },
+		{ "g_debugSurveillance", "Surveillance", "Draws surveillance camera states and sightings" }
+	};
+	static_assert(CRY_ARRAY_COUNT(categoryDescs) == (int)EDebugCategory::Count, "Category descriptions don't match EDebugCategory");
+}
+
+int CDebugOverlay::s_categories[(int)EDebugCategory::Count] = {};
+
+void CDebugOverlay::RegisterCVars()
+{
+	for (int i = 0; i < (int)EDebugCategory::Count; ++i)
+	{
+		ConsoleRegistrationHelper::Register(categoryDescs[i].szCVarName, &s_categories[i], 0, VF_CHEAT, categoryDescs[i].szHelp);
+	}
+}
+
+void CDebugOverlay::UnregisterCVars()
+{
+	for (const SCategoryDesc& desc : categoryDescs)
+	{
+		gEnv->pConsole->UnregisterVariable(desc.szCVarName, true);
+	}
+}
+
+CDebugOverlay::SRecord* CDebugOverlay::Push(EDebugCategory category, EShape shape, const Vec3& pos, float size, const ColorF& color, float duration)
+{
+	if (m_recordCount >= MaxRecords)
+	{
+		++m_droppedCount;
+		return nullptr;
+	}
+
+	SRecord& record = m_records[m_recordCount++];
+	record.category = category;
+	record.shape = shape;
+	record.argCount = 0;
+	record.pos = pos;
+	record.size = size;
+	record.color = color;
+	record.duration = duration;
+	record.szFormat = nullptr;
+
+	return &record;
+}
+
+void CDebugOverlay::Flush()
+{
+	if (m_recordCount == 0)
+		return;
+
+	IPersistantDebug* pPD = gEnv->pGameFramework ? gEnv->pGameFramework->GetIPersistantDebug() : nullptr;
+	if (pPD == nullptr)
+	{
+		m_recordCount = 0;
+		return;
+	}
+
+	// One group per category, records of a category are drawn together
+	for (int category = 0; category < (int)EDebugCategory::Count; ++category)
+	{
+		bool bBegun = false;
+
+		for (uint32 i = 0; i < m_recordCount; ++i)
+		{
+			const SRecord& record = m_records[i];
+			if ((int)record.category != category || !IsEnabled(record.category))
+				continue;
+
+			if (!bBegun)
+			{
+				pPD->Begin(categoryDescs[category].szGroupName, false);
+				bBegun = true;
+			}
+
+			switch (record.shape)
+			{
+			case EShape::Sphere:
+				pPD->AddSphere(record.pos, record.size, record.color, record.duration);
+				break;
+			case EShape::Text2D:
+			case EShape::Text3D:
+			{
+				char szText[256];
+				Format(record, szText, sizeof(szText));
+
+				if (record.shape == EShape::Text2D)
+					pPD->AddText(record.pos.x, record.pos.y, record.size, record.color, record.duration, "%s", szText);
+				else
+					pPD->AddText3D(record.pos, record.size, record.color, record.duration, "%s", szText);
+			}
+			break;
+			}
+		}
+	}
+
+	if (m_droppedCount > 0)
+	{
+		pPD->Begin("DebugOverlay", false);
+		pPD->AddText(10.f, 10.f, 1.5f, ColorF(1.f, 0.f, 0.f), 1.f, "debug overlay full, %u primitives dropped", m_droppedCount);
+		m_droppedCount = 0;
+	}
+
+	m_recordCount = 0;
+}
+
+void CDebugOverlay::Format(const SRecord& record, char* szBuffer, size_t bufferSize)
+{
+	// Walks the format string and prints each conversion with its stored argument
+	size_t length = 0;
+	uint32 argIndex = 0;
+
+	for (const char* szCursor = record.szFormat; *szCursor != '\0' && length + 1 < bufferSize; )
+	{
+		if (*szCursor != '%')
+		{
+			szBuffer[length++] = *szCursor++;
+			continue;
+		}
+
+		if (szCursor[1] == '%')
+		{
+			szBuffer[length++] = '%';
+			szCursor += 2;
+			continue;
+		}
+
+		// Copy the conversion specification, e.g. "%.2f"
+		char szSpec[16];
+		size_t specLength = 0;
+		do
+		{
+			szSpec[specLength++] = *szCursor++;
+		}
+		while (*szCursor != '\0' && strchr("diufFeEgGxXcs", *szCursor) == nullptr && specLength + 2 < sizeof(szSpec));
+
+		if (*szCursor != '\0')
+		{
+			szSpec[specLength++] = *szCursor++;
+		}
+		szSpec[specLength] = '\0';
+
+		if (argIndex >= record.argCount)
+			break;
+
+		const SArg& arg = record.args[argIndex++];
+		char* szOut = szBuffer + length;
+		const size_t outSize = bufferSize - length;
+		switch (arg.type)
+		{
+		case SArg::EType::Int:
+			cry_sprintf(szOut, outSize, szSpec, arg.i);
+			break;
+		case SArg::EType::Float:
+			cry_sprintf(szOut, outSize, szSpec, arg.f);
+			break;
+		case SArg::EType::String:
+			cry_sprintf(szOut, outSize, szSpec, arg.sz ? arg.sz : "");
+			break;
+		}
+		length += strlen(szOut);
+	}
+
+	szBuffer[min(length, bufferSize - 1)] = '\0';
+}
+
+#endif
@@ -0,0 +1,150 @@
+#pragma once
+
+// Gameplay debug drawing is compiled out of release builds
+#if !defined(_RELEASE)
+	#define GAME_DEBUG_OVERLAY 1
+#endif
+
+enum class EDebugCategory : uint8
+{
+	State = 0,
+	Camera,
+	Headroom,
+	Interaction,
+	Surveillance,
+	Count
+};
+
+#if defined(GAME_DEBUG_OVERLAY)
+
+////////////////////////////////////////////////////////
+// Per-frame buffer of debug primitives, drawn through IPersistantDebug once per frame
+// Primitives keep their format string and typed arguments, text is only formatted when the buffer is flushed
+// Use through GAME_DEBUG_DRAW so that nothing is evaluated while the category is disabled
+////////////////////////////////////////////////////////
+class CDebugOverlay
+{
+public:
+	static const uint32 MaxArgs = 4;
+	static const uint32 MaxRecords = 256;
+
+	struct SArg
+	{
+		enum class EType : uint8
+		{
+			Int,
+			Float,
+			String
+		};
+
+		SArg() : type(EType::Int), i(0) {}
+		SArg(int value) : type(EType::Int), i(value) {}
+		SArg(bool value) : type(EType::Int), i(value ? 1 : 0) {}
+		SArg(float value) : type(EType::Float), f(value) {}
+		SArg(const char* szValue) : type(EType::String), sz(szValue) {}
+
+		EType type;
+		union
+		{
+			int i;
+			float f;
+			// Has to outlive the frame, e.g. a literal or an entity class name
+			const char* sz;
+		};
+	};
+
+public:
+	// Bound to the g_debug* category variables
+	static bool IsEnabled(EDebugCategory category) { return s_categories[(int)category] != 0; }
+
+	static void RegisterCVars();
+	static void UnregisterCVars();
+
+	template<typename... TArgs>
+	void AddText(EDebugCategory category, float x, float y, float size, const ColorF& color, float duration, const char* szFormat, TArgs... args)
+	{
+		static_assert(sizeof...(TArgs) <= MaxArgs, "Too many debug text arguments");
+		if (SRecord* pRecord = Push(category, EShape::Text2D, Vec3(x, y, 0.f), size, color, duration))
+		{
+			SetText(*pRecord, szFormat, args...);
+		}
+	}
+
+	template<typename... TArgs>
+	void AddText3D(EDebugCategory category, const Vec3& pos, float size, const ColorF& color, float duration, const char* szFormat, TArgs... args)
+	{
+		static_assert(sizeof...(TArgs) <= MaxArgs, "Too many debug text arguments");
+		if (SRecord* pRecord = Push(category, EShape::Text3D, pos, size, color, duration))
+		{
+			SetText(*pRecord, szFormat, args...);
+		}
+	}
+
+	void AddSphere(EDebugCategory category, const Vec3& pos, float radius, const ColorF& color, float duration)
+	{
+		Push(category, EShape::Sphere, pos, radius, color, duration);
+	}
+
+	// Formats and draws the primitives added since the last call
+	void Flush();
+
+protected:
+	enum class EShape : uint8
+	{
+		Text2D,
+		Text3D,
+		Sphere
+	};
+
+	struct SRecord
+	{
+		EDebugCategory category;
+		EShape shape;
+		uint8 argCount;
+		Vec3 pos;
+		// Font size or sphere radius
+		float size;
+		ColorF color;
+		float duration;
+		const char* szFormat;
+		SArg args[MaxArgs];
+	};
+
+	SRecord* Push(EDebugCategory category, EShape shape, const Vec3& pos, float size, const ColorF& color, float duration);
+
+	template<typename... TArgs>
+	static void SetText(SRecord& record, const char* szFormat, TArgs... args)
+	{
+		const SArg packed[] = { SArg(), SArg(args)... };
+		record.szFormat = szFormat;
+		record.argCount = static_cast<uint8>(sizeof...(TArgs));
+		for (uint32 i = 0; i < sizeof...(TArgs); ++i)
+		{
+			record.args[i] = packed[i + 1];
+		}
+	}
+
+	static void Format(const SRecord& record, char* szBuffer, size_t bufferSize);
+
+protected:
+	SRecord m_records[MaxRecords];
+	uint32 m_recordCount = 0;
+	uint32 m_droppedCount = 0;
+
+	static int s_categories[(int)EDebugCategory::Count];
+};
+
+	// e.g. GAME_DEBUG_DRAW(EDebugCategory::Camera, AddText, 10.f, 10.f, 2.f, color, 1.f, "hit at %f", x);
+	// Arguments are only evaluated when the category is enabled
+	#define GAME_DEBUG_DRAW(category, primitive, ...)                                     \
+		do                                                                                \
+		{                                                                                 \
+			if (CDebugOverlay::IsEnabled(category))                                       \
+			{                                                                             \
+				if (CGamePlugin* pDebugPlugin = CGamePlugin::GetInstance())               \
+					pDebugPlugin->GetDebugOverlay().primitive(category, __VA_ARGS__);     \
+			}                                                                             \
+		} while (false)
+#else
+	#define GAME_DEBUG_DRAW(category, primitive, ...) do {} while (false)
+#endif
@@ -0,0 +1,176 @@
+#include "StdAfx.h"
+#include "EventLog.h"
+
+#include <CrySystem/File/ICryPak.h>
+
+std::atomic<CEventLog*> CEventLog::s_pActive { nullptr };
+
+namespace
+{
+	// Interval at which the flush thread drains the rings
+	const auto FlushInterval = std::chrono::milliseconds(100);
+
+	// Ring of the calling thread and the log it was taken from
+	thread_local const CEventLog* t_pRingOwner = nullptr;
+	thread_local void* t_pRing = nullptr;
+}
+
+bool CEventLog::Start(const char* szPath)
+{
+	if (m_pFile != nullptr)
+		return true;
+
+	char szAdjustedPath[_MAX_PATH];
+	gEnv->pCryPak->AdjustFileName(szPath, szAdjustedPath, ICryPak::FLAGS_FOR_WRITING);
+
+	m_pFile = fopen(szAdjustedPath, "wb");
+	if (m_pFile == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "Event log: could not open %s for writing", szAdjustedPath);
+		return false;
+	}
+
+	const EventLog::SFileHeader header = { EventLog::FileMagic, EventLog::FileVersion, static_cast<uint64_t>(CryGetTicksPerSec()) };
+	fwrite(&header, sizeof(header), 1, m_pFile);
+
+	// Records left over from an earlier session belong to the old file
+	for (const std::unique_ptr<SRing>& pRing : m_rings)
+	{
+		pRing->tail.store(pRing->head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	m_bStopRequested = false;
+	m_thread = std::thread(&CEventLog::FlushThread, this);
+
+	s_pActive.store(this, std::memory_order_release);
+	return true;
+}
+
+void CEventLog::Stop()
+{
+	if (m_pFile == nullptr)
+		return;
+
+	s_pActive.store(nullptr, std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeLock);
+		m_bStopRequested = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+
+	Drain();
+	fclose(m_pFile);
+	m_pFile = nullptr;
+}
+
+void CEventLog::Write(EventLog::EEvent event, EntityId entityId, float arg0, float arg1, float arg2, float arg3)
+{
+	CEventLog* pLog = s_pActive.load(std::memory_order_acquire);
+	if (pLog == nullptr)
+		return;
+
+	SRing& ring = *pLog->GetThreadRing();
+
+	const uint32 head = ring.head.load(std::memory_order_relaxed);
+	if (head - ring.tail.load(std::memory_order_acquire) >= RingCapacity)
+	{
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	EventLog::SRecord& record = ring.records[head & (RingCapacity - 1)];
+	record.event = static_cast<uint16_t>(event);
+	record.thread = ring.index;
+	record.entityId = entityId;
+	record.ticks = CryGetTicks();
+	record.args[0] = arg0;
+	record.args[1] = arg1;
+	record.args[2] = arg2;
+	record.args[3] = arg3;
+
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+CEventLog::SRing* CEventLog::GetThreadRing()
+{
+	if (t_pRingOwner == this)
+		return static_cast<SRing*>(t_pRing);
+
+	// First event of this thread, the lock is only taken once per thread
+	std::lock_guard<std::mutex> lock(m_ringsLock);
+	m_rings.emplace_back(new SRing());
+	m_rings.back()->index = static_cast<uint16>(m_rings.size() - 1);
+
+	t_pRingOwner = this;
+	t_pRing = m_rings.back().get();
+	return m_rings.back().get();
+}
+
+void CEventLog::FlushThread()
+{
+	std::unique_lock<std::mutex> lock(m_wakeLock);
+	while (!m_bStopRequested)
+	{
+		m_wake.wait_for(lock, FlushInterval);
+
+		lock.unlock();
+		Drain();
+		lock.lock();
+	}
+}
+
+uint32 CEventLog::Drain()
+{
+	std::lock_guard<std::mutex> lock(m_ringsLock);
+
+	uint32 count = 0;
+	for (const std::unique_ptr<SRing>& pRing : m_rings)
+	{
+		SRing& ring = *pRing;
+		const uint32 tail = ring.tail.load(std::memory_order_relaxed);
+		const uint32 head = ring.head.load(std::memory_order_acquire);
+		if (head == tail)
+			continue;
+
+		// Pending records may wrap around the end of the ring
+		const uint32 begin = tail & (RingCapacity - 1);
+		const uint32 pending = head - tail;
+		const uint32 firstPart = min(pending, RingCapacity - begin);
+		fwrite(&ring.records[begin], sizeof(EventLog::SRecord), firstPart, m_pFile);
+		fwrite(&ring.records[0], sizeof(EventLog::SRecord), pending - firstPart, m_pFile);
+
+		ring.tail.store(head, std::memory_order_release);
+		count += pending;
+	}
+
+	if (count > 0)
+	{
+		fflush(m_pFile);
+		m_written.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	return count;
+}
+
+CEventLog::SStatistics CEventLog::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_ringsLock);
+
+	SStatistics statistics;
+	statistics.written = m_written.load(std::memory_order_relaxed);
+	statistics.threads = static_cast<uint32>(m_rings.size());
+	for (const std::unique_ptr<SRing>& pRing : m_rings)
+	{
+		statistics.dropped += pRing->dropped.load(std::memory_order_relaxed);
+	}
+	return statistics;
+}
+
+void CEventLog::LogStatistics() const
+{
+	const SStatistics statistics = GetStatistics();
+	CryLogAlways("Event log: %s, %" PRIu64 " records written, %" PRIu64 " dropped, %u thread rings",
+		m_pFile != nullptr ? "running" : "stopped", statistics.written, statistics.dropped, statistics.threads);
+}
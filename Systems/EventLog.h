@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EventLogFormat.h"
+
+////////////////////////////////////////////////////////
+// Binary log for gameplay events on hot paths, replaces formatted CryLog output
+// Each writing thread owns a single producer ring, a background thread drains the rings to a file
+// Decode the file with Tools/EventLogDecoder
+////////////////////////////////////////////////////////
+class CEventLog
+{
+public:
+	struct SStatistics
+	{
+		uint64 written = 0;
+		// Records lost because a ring was full
+		uint64 dropped = 0;
+		uint32 threads = 0;
+	};
+
+public:
+	static constexpr const char* DefaultPath = "%USER%/GameEvents.bin";
+
+public:
+	~CEventLog() { Stop(); }
+
+	// Opens the file and starts the flush thread, events are discarded while stopped
+	bool Start(const char* szPath);
+	void Stop();
+
+	// Safe to call from any thread, only the first call on a thread takes a lock
+	static void Write(EventLog::EEvent event, EntityId entityId, float arg0 = 0.f, float arg1 = 0.f, float arg2 = 0.f, float arg3 = 0.f);
+
+	SStatistics GetStatistics() const;
+	void LogStatistics() const;
+
+protected:
+	static const uint32 RingCapacity = 4096;
+	static_assert((RingCapacity & (RingCapacity - 1)) == 0, "Ring capacity has to be a power of two");
+
+	struct SRing
+	{
+		EventLog::SRecord records[RingCapacity];
+		// Written by the owning thread only
+		std::atomic<uint32> head { 0 };
+		// Written by the flush thread only
+		std::atomic<uint32> tail { 0 };
+		std::atomic<uint64> dropped { 0 };
+		uint16 index = 0;
+	};
+
+	SRing* GetThreadRing();
+	void FlushThread();
+	// Writes all pending records to the file, returns the number of records written
+	uint32 Drain();
+
+protected:
+	static std::atomic<CEventLog*> s_pActive;
+
+	mutable std::mutex m_ringsLock;
+	// Kept until destruction, a thread keeps its ring across Stop and Start
+	std::vector<std::unique_ptr<SRing>> m_rings;
+
+	FILE* m_pFile = nullptr;
+	std::thread m_thread;
+	std::mutex m_wakeLock;
+	std::condition_variable m_wake;
+	bool m_bStopRequested = false;
+
+	std::atomic<uint64> m_written { 0 };
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+// Shared between the game and the offline decoder, keep free of engine headers
+#include <cstdint>
+
+namespace EventLog
+{
+	// Append only, the decoder relies on the numbering of existing events
+	enum class EEvent : uint16_t
+	{
+		ThrowStart = 0,
+		ThrowDirection,
+		ThrowOrigin,
+		ThrowEnd,
+		ThrowSound,
+		DestroyableHit,
+		ColliderSwap,
+		ColliderRebuild,
+		Count
+	};
+
+	static const uint32_t MaxArgs = 4;
+
+	// Fixed size record, written as is
+	struct SRecord
+	{
+		uint16_t event;
+		// Index of the writing thread, in order of first use
+		uint16_t thread;
+		uint32_t entityId;
+		// CryGetTicks() at the time of the event
+		uint64_t ticks;
+		float args[MaxArgs];
+	};
+	static_assert(sizeof(SRecord) == 32, "Event log records are expected to be 32 bytes");
+
+	static const uint32_t FileMagic = 0x4C564547; // "GEVL"
+	static const uint32_t FileVersion = 1;
+
+	struct SFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t ticksPerSecond;
+	};
+
+	struct SEventDesc
+	{
+		const char* szName;
+		// printf format for the arguments, always given all MaxArgs values as doubles
+		const char* szFormat;
+	};
+
+	inline const SEventDesc& GetEventDesc(EEvent event)
+	{
+		static const SEventDesc descs[] =
+		{
+			{ "ThrowStart", "" },
+			{ "ThrowDirection", "%f, %f, %f" },
+			{ "ThrowOrigin", "%f, %f, %f" },
+			{ "ThrowEnd", "" },
+			{ "ThrowSound", "" },
+			{ "DestroyableHit", "mass %f, life %f" },
+			{ "ColliderSwap", "crouch %.0f" },
+			{ "ColliderRebuild", "" }
+		};
+		static_assert(sizeof(descs) / sizeof(descs[0]) == (size_t)EEvent::Count, "Event descriptions don't match EEvent");
+
+		static const SEventDesc unknown = { "Unknown", "" };
+		return event < EEvent::Count ? descs[(size_t)event] : unknown;
+	}
+}
@@ -0,0 +1,172 @@
+#include "StdAfx.h"
+#include "GameAssets.h"
+
+#include <CryRenderer/IRenderer.h>
+
+namespace
+{
+	// Keep in sync with the defaults of the component properties using them
+	const char* const szGeometryPaths[] =
+	{
+		"Objects/Default/primitive_sphere.cgf",
+		"Objects/default/primitive_box.cgf",
+		"Objects/default/primitive_sphere.cgf",
+		"Objects/player_use/surveilance_camera/surveillance_camera.cgf",
+		"Objects/player_use/surveilance_camera/surveillance_camera_mount.cgf"
+	};
+	static_assert(CRY_ARRAY_COUNT(szGeometryPaths) == (int)CGameAssets::EGeometry::Count, "Geometry paths don't match EGeometry");
+
+	const char* const szBulletMaterialPath = "Materials/bullet";
+	const char* const szProjectorMaterialPath = "Assets/materials/softedge.mtl";
+	const char* const szProjectorTexturePath = "%ENGINE%/EngineAssets/Textures/lights/flashlight_projector.dds";
+}
+
+void CGameAssets::Preload()
+{
+	if (m_bPreloaded)
+		return;
+
+	for (int i = 0; i < (int)EGeometry::Count; ++i)
+	{
+		m_fixedGeometry[i] = GetGeometry(szGeometryPaths[i]);
+	}
+
+	m_pBulletMaterial = GetMaterial(szBulletMaterialPath);
+	GetMaterial(szProjectorMaterialPath);
+
+	if (gEnv->pRenderer)
+	{
+		CountLookup();
+		m_pProjectorTexture = gEnv->pRenderer->EF_LoadTexture(szProjectorTexturePath, FT_DONT_STREAM);
+	}
+
+	m_bPreloaded = true;
+}
+
+void CGameAssets::Release()
+{
+	m_geometry.clear();
+	m_materials.clear();
+
+	for (IStatObj*& pGeometry : m_fixedGeometry)
+	{
+		pGeometry = nullptr;
+	}
+	m_pBulletMaterial = nullptr;
+	SAFE_RELEASE(m_pProjectorTexture);
+
+	m_bPreloaded = false;
+}
+
+IStatObj* CGameAssets::GetGeometry(EGeometry geometry)
+{
+	if (IStatObj* pGeometry = m_fixedGeometry[(int)geometry])
+	{
+		++m_statistics.hits;
+		return pGeometry;
+	}
+
+	return GetGeometry(szGeometryPaths[(int)geometry]);
+}
+
+IMaterial* CGameAssets::GetBulletMaterial()
+{
+	if (m_pBulletMaterial != nullptr)
+	{
+		++m_statistics.hits;
+		return m_pBulletMaterial;
+	}
+
+	return GetMaterial(szBulletMaterialPath);
+}
+
+ITexture* CGameAssets::GetProjectorTexture()
+{
+	if (m_pProjectorTexture != nullptr)
+	{
+		++m_statistics.hits;
+	}
+
+	return m_pProjectorTexture;
+}
+
+IStatObj* CGameAssets::GetGeometry(const char* szPath)
+{
+	for (const SEntry<IStatObj>& entry : m_geometry)
+	{
+		if (stricmp(entry.path.c_str(), szPath) == 0)
+		{
+			++m_statistics.hits;
+			return entry.pAsset;
+		}
+	}
+
+	return LoadGeometry(szPath);
+}
+
+IMaterial* CGameAssets::GetMaterial(const char* szPath)
+{
+	for (const SEntry<IMaterial>& entry : m_materials)
+	{
+		if (stricmp(entry.path.c_str(), szPath) == 0)
+		{
+			++m_statistics.hits;
+			return entry.pAsset;
+		}
+	}
+
+	return LoadMaterial(szPath);
+}
+
+void CGameAssets::LogStatistics() const
+{
+	CryLogAlways("Game assets: %" PRISIZE_T " geometries, %" PRISIZE_T " materials resident, projector texture %s",
+		m_geometry.size(), m_materials.size(), m_pProjectorTexture ? "resident" : "missing");
+	CryLogAlways("    %u handle hits, %u path lookups while preloading, %u path lookups afterwards",
+		m_statistics.hits, m_statistics.preloadLookups, m_statistics.runtimeLookups);
+}
+
+IStatObj* CGameAssets::LoadGeometry(const char* szPath)
+{
+	CountLookup();
+
+	IStatObj* pGeometry = gEnv->p3DEngine->LoadStatObj(szPath);
+	if (pGeometry == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "Failed to load geometry %s", szPath);
+		return nullptr;
+	}
+
+	SEntry<IStatObj> entry;
+	entry.path = szPath;
+	entry.pAsset = pGeometry;
+	m_geometry.push_back(entry);
+
+	return pGeometry;
+}
+
+IMaterial* CGameAssets::LoadMaterial(const char* szPath)
+{
+	CountLookup();
+
+	IMaterial* pMaterial = gEnv->p3DEngine->GetMaterialManager()->LoadMaterial(szPath, false);
+	if (pMaterial == nullptr)
+	{
+		return nullptr;
+	}
+
+	SEntry<IMaterial> entry;
+	entry.path = szPath;
+	entry.pAsset = pMaterial;
+	m_materials.push_back(entry);
+
+	return pMaterial;
+}
+
+void CGameAssets::CountLookup()
+{
+	if (m_bPreloaded)
+		++m_statistics.runtimeLookups;
+	else
+		++m_statistics.preloadLookups;
+}
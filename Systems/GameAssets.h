@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include <Cry3DEngine/IStatObj.h>
+#include <Cry3DEngine/IMaterial.h>
+#include <CryRenderer/ITexture.h>
+
+////////////////////////////////////////////////////////
+// Resident handles for the fixed assets used by our components
+// Filled once on ESYSTEM_EVENT_GAME_POST_INIT, components then use these handles instead of loading by path
+////////////////////////////////////////////////////////
+class CGameAssets
+{
+public:
+	// Geometry with a fixed path, preloaded
+	enum class EGeometry
+	{
+		BulletSphere = 0,
+		DestroyableIntact,
+		DestroyableDestroyed,
+		SurveillanceCamera,
+		SurveillanceMount,
+		Count
+	};
+
+	struct SStatistics
+	{
+		// Path based loads issued while preloading
+		uint32 preloadLookups = 0;
+		// Path based loads issued afterwards, expected to stay at zero during gameplay
+		uint32 runtimeLookups = 0;
+		// Requests served from resident handles
+		uint32 hits = 0;
+	};
+
+public:
+	void Preload();
+	void Release();
+
+	IStatObj* GetGeometry(EGeometry geometry);
+	IMaterial* GetBulletMaterial();
+	ITexture* GetProjectorTexture();
+
+	// Resolve assets configured through component properties, only loads by path if the asset isn't resident yet
+	IStatObj* GetGeometry(const char* szPath);
+	IMaterial* GetMaterial(const char* szPath);
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void LogStatistics() const;
+
+protected:
+	template<typename T>
+	struct SEntry
+	{
+		string path;
+		_smart_ptr<T> pAsset;
+	};
+
+	IStatObj* LoadGeometry(const char* szPath);
+	IMaterial* LoadMaterial(const char* szPath);
+	void CountLookup();
+
+protected:
+	std::vector<SEntry<IStatObj>> m_geometry;
+	std::vector<SEntry<IMaterial>> m_materials;
+
+	IStatObj* m_fixedGeometry[(int)EGeometry::Count] = {};
+	IMaterial* m_pBulletMaterial = nullptr;
+	ITexture* m_pProjectorTexture = nullptr;
+
+	bool m_bPreloaded = false;
+	SStatistics m_statistics;
+};
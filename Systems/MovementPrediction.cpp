@@ -0,0 +1,264 @@
+#include "StdAfx.h"
+#include "MovementPrediction.h"
+
+#include <CrySystem/IConsole.h>
+
+#include <deque>
+
+CMovementPredictor::SStatistics CMovementPredictor::s_statistics;
+CMovementAuthority::SStatistics CMovementAuthority::s_statistics;
+
+MovementPrediction::SMovementState MovementPrediction::Step(const SMovementState& state, const SInputCommand& command, const SGameSettings& settings)
+{
+	SMovementState next = state;
+
+	// Only the condition bits, the velocity is a request to the character controller and not a distance
+	PlayerSimulation::StepMovement(command.inputFlags, state.state, settings, command.frameTime, next.conditions);
+
+	next.look = PlayerSimulation::StepLook(state.look, command.lookDelta, settings);
+	next.state = PlayerStateMachine::Lookup(state.state, next.conditions).next;
+
+	return next;
+}
+
+void CMovementPredictor::Record(const MovementPrediction::SInputCommand& command, const MovementPrediction::SMovementState& predicted)
+{
+	if (m_count == MaxPendingCommands)
+	{
+		DropFirst(1);
+		++s_statistics.overflows;
+	}
+
+	SPending& pending = m_pending[(m_first + m_count) % MaxPendingCommands];
+	pending.command = command;
+	pending.predicted = predicted;
+	++m_count;
+
+	++s_statistics.commands;
+}
+
+uint32 CMovementPredictor::GetCommandsToSend(MovementPrediction::SInputCommand* pCommands, uint32 maxCount) const
+{
+	const uint32 count = min(maxCount, m_count);
+	for (uint32 i = 0; i < count; ++i)
+	{
+		pCommands[i] = GetPending(m_count - count + i).command;
+	}
+
+	return count;
+}
+
+bool CMovementPredictor::Reconcile(uint32 ackSequence, const MovementPrediction::SMovementState& authoritative, const SGameSettings& settings, MovementPrediction::SMovementState& corrected)
+{
+	// Drop the commands the server is done with, up to the acknowledged one
+	uint32 dropCount = 0;
+	while (dropCount < m_count && GetPending(dropCount).command.sequence < ackSequence)
+	{
+		++dropCount;
+	}
+	DropFirst(dropCount);
+
+	// Acknowledgement of a command that is already gone, e.g. an older state arriving late
+	if (m_count == 0 || GetPending(0).command.sequence != ackSequence)
+		return false;
+
+	const MovementPrediction::SMovementState predicted = GetPending(0).predicted;
+	DropFirst(1);
+	++s_statistics.acks;
+
+	const float error = predicted.position.GetDistance(authoritative.position);
+	s_statistics.maxError = max(s_statistics.maxError, error);
+
+	if (error <= CorrectionDistance && predicted.state == authoritative.state)
+		return false;
+
+	// Start over from the server state and apply what the server hasn't seen yet, positions keep what the client moved since
+	const Vec3 positionError = authoritative.position - predicted.position;
+	corrected = authoritative;
+	for (uint32 i = 0; i < m_count; ++i)
+	{
+		SPending& pending = GetPending(i);
+		corrected = MovementPrediction::Step(corrected, pending.command, settings);
+		corrected.position = pending.predicted.position + positionError;
+		pending.predicted = corrected;
+	}
+
+	++s_statistics.corrections;
+	s_statistics.replayedCommands += m_count;
+	return true;
+}
+
+bool CMovementAuthority::Accept(const MovementPrediction::SInputCommand& command)
+{
+	if (command.sequence <= m_lastSequence)
+	{
+		++s_statistics.duplicates;
+		return false;
+	}
+
+	s_statistics.missed += command.sequence - m_lastSequence - 1;
+	++s_statistics.accepted;
+
+	m_lastSequence = command.sequence;
+	return true;
+}
+
+void MovementPrediction::LogStatistics(IConsoleCmdArgs* pArgs)
+{
+	const CMovementPredictor::SStatistics& prediction = CMovementPredictor::s_statistics;
+	const CMovementAuthority::SStatistics& authoritative = CMovementAuthority::s_statistics;
+
+	CryLogAlways("Movement prediction: %u commands predicted, %u acknowledged, %u corrections, %u commands re-simulated, %u dropped unacknowledged, max error %.3f",
+		prediction.commands, prediction.acks, prediction.corrections, prediction.replayedCommands, prediction.overflows, prediction.maxError);
+	CryLogAlways("    server: %u commands applied, %u repeated, %u missed, %u merged into one step, %u applied early to catch up",
+		authoritative.accepted, authoritative.duplicates, authoritative.missed, authoritative.merged, authoritative.caughtUp);
+
+	CMovementPredictor::s_statistics = CMovementPredictor::SStatistics();
+	CMovementAuthority::s_statistics = CMovementAuthority::SStatistics();
+}
+
+void MovementPrediction::RunLoopbackTest(IConsoleCmdArgs* pArgs)
+{
+	const float roundTripMs = pArgs->GetArgCount() > 1 ? max((float)atof(pArgs->GetArg(1)), 0.f) : 100.f;
+	const float lossPercent = pArgs->GetArgCount() > 2 ? CLAMP((float)atof(pArgs->GetArg(2)), 0.f, 100.f) : 5.f;
+	const float seconds = pArgs->GetArgCount() > 3 ? max((float)atof(pArgs->GetArg(3)), 1.f) : 60.f;
+
+	const float frameTime = 1.f / 60.f;
+	const int frameCount = static_cast<int>(seconds / frameTime);
+	// Half the round trip in each direction
+	const int latencyFrames = static_cast<int>(roundTripMs * 0.0005f / frameTime + 0.5f);
+	// The server is pushed by something the client can't predict every few seconds, e.g. a collision
+	const int pushInterval = static_cast<int>(5.f / frameTime);
+	const SGameSettings& settings = CUserSettings::Get();
+
+	struct SInputPacket
+	{
+		int arrivalFrame;
+		uint32 count;
+		SInputCommand commands[CMovementPredictor::RedundantCommands];
+	};
+	struct SStatePacket
+	{
+		int arrivalFrame;
+		uint32 ackSequence;
+		SMovementState state;
+	};
+
+	// The game keeps counting in the statistics of the real players
+	const CMovementPredictor::SStatistics gamePredictorStatistics = CMovementPredictor::s_statistics;
+	const CMovementAuthority::SStatistics gameAuthorityStatistics = CMovementAuthority::s_statistics;
+	CMovementPredictor::s_statistics = CMovementPredictor::SStatistics();
+	CMovementAuthority::s_statistics = CMovementAuthority::SStatistics();
+
+	CMovementPredictor predictor;
+	CMovementAuthority authority;
+	SMovementState client;
+	SMovementState server;
+
+	// Stand-in for the character controller on both ends, the reconciliation only sees the positions it produces
+	auto stepWithMovement = [&settings](const SMovementState& state, const SInputCommand& command)
+	{
+		uint8 conditions = state.conditions;
+		const Vec3 velocity = PlayerSimulation::StepMovement(command.inputFlags, state.state, settings, command.frameTime, conditions);
+
+		SMovementState next = Step(state, command, settings);
+		next.position += state.look.GetYawOrientation() * velocity;
+		return next;
+	};
+
+	std::deque<SInputPacket> inputPackets;
+	std::deque<SStatePacket> statePackets;
+
+	CRndGen random(0x5eed);
+	PlayerSimulation::TInputFlags inputFlags = 0;
+	uint32 inputSent = 0, inputLost = 0, stateSent = 0, stateLost = 0, pushes = 0, maxPending = 0;
+
+	const CTimeValue start = gEnv->pTimer->GetAsyncTime();
+
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		// Client, input changes a few times per second and the mouse moves every frame
+		if (random.GetRandom(0u, 19u) == 0)
+		{
+			inputFlags = static_cast<PlayerSimulation::TInputFlags>(random.GetRandom(0u, 31u));
+		}
+
+		SInputCommand command;
+		command.sequence = predictor.CreateSequence();
+		command.inputFlags = inputFlags;
+		command.lookDelta = Vec2(random.GetRandom(-10.f, 10.f), random.GetRandom(-5.f, 5.f));
+		command.frameTime = frameTime;
+
+		client = stepWithMovement(client, command);
+		predictor.Record(command, client);
+
+		SInputPacket inputPacket;
+		inputPacket.arrivalFrame = frame + latencyFrames;
+		inputPacket.count = predictor.GetCommandsToSend(inputPacket.commands, CMovementPredictor::RedundantCommands);
+		++inputSent;
+		if (random.GetRandom(0.f, 100.f) < lossPercent)
+			++inputLost;
+		else
+			inputPackets.push_back(inputPacket);
+
+		// Server, applies every command it hasn't seen yet and answers with the resulting state
+		while (!inputPackets.empty() && inputPackets.front().arrivalFrame <= frame)
+		{
+			const SInputPacket& packet = inputPackets.front();
+			for (uint32 i = 0; i < packet.count; ++i)
+			{
+				if (authority.Accept(packet.commands[i]))
+				{
+					server = stepWithMovement(server, packet.commands[i]);
+				}
+			}
+			inputPackets.pop_front();
+		}
+
+		if (frame > 0 && frame % pushInterval == 0)
+		{
+			server.position.x += 1.f;
+			++pushes;
+		}
+
+		if (authority.GetLastSequence() != 0)
+		{
+			++stateSent;
+			if (random.GetRandom(0.f, 100.f) < lossPercent)
+				++stateLost;
+			else
+				statePackets.push_back({ frame + latencyFrames, authority.GetLastSequence(), server });
+		}
+
+		// Client, takes over corrections
+		while (!statePackets.empty() && statePackets.front().arrivalFrame <= frame)
+		{
+			const SStatePacket& packet = statePackets.front();
+			SMovementState corrected;
+			if (predictor.Reconcile(packet.ackSequence, packet.state, settings, corrected))
+			{
+				client = corrected;
+			}
+			statePackets.pop_front();
+		}
+
+		maxPending = max(maxPending, predictor.GetPendingCount());
+	}
+
+	const float timeMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+	const CMovementPredictor::SStatistics& prediction = CMovementPredictor::s_statistics;
+	const CMovementAuthority::SStatistics& authoritative = CMovementAuthority::s_statistics;
+
+	CryLogAlways("Loopback test: %.0f s at 60 fps, %.0f ms round trip, %.1f%% loss in both directions", seconds, roundTripMs, lossPercent);
+	CryLogAlways("    input packets %u sent, %u lost, commands missed by the server %u, repeated commands %u",
+		inputSent, inputLost, authoritative.missed, authoritative.duplicates);
+	CryLogAlways("    state packets %u sent, %u lost, %u unpredictable server pushes", stateSent, stateLost, pushes);
+	CryLogAlways("    corrections %u (%.2f per second, %.1f%% of acknowledgements), max error %.3f",
+		prediction.corrections, prediction.corrections / seconds, 100.f * prediction.corrections / max(prediction.acks, 1u), prediction.maxError);
+	CryLogAlways("    re-simulated %u commands, %.1f per correction, %.2f per frame, up to %u commands pending",
+		prediction.replayedCommands, (float)prediction.replayedCommands / max(prediction.corrections, 1u), (float)prediction.replayedCommands / max(frameCount, 1), maxPending);
+	CryLogAlways("    client and server %.3f apart at the end, test took %.2f ms", client.position.GetDistance(server.position), timeMs);
+
+	CMovementPredictor::s_statistics = gamePredictorStatistics;
+	CMovementAuthority::s_statistics = gameAuthorityStatistics;
+}
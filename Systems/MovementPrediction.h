@@ -0,0 +1,151 @@
+#pragma once
+
+#include "../Components/PlayerSimulation.h"
+
+struct IConsoleCmdArgs;
+
+////////////////////////////////////////////////////////
+// Client-side prediction and server reconciliation of player movement
+// Clients send numbered input commands to the server and move right away, the server applies the commands authoritatively
+// and answers with the last applied command and the resulting state, clients then replay the commands the server hasn't seen yet
+////////////////////////////////////////////////////////
+namespace MovementPrediction
+{
+	// One frame of player input
+	struct SInputCommand
+	{
+		// Input tick of the player, see PlayerInput::CRing
+		uint32 sequence = 0;
+		PlayerSimulation::TInputFlags inputFlags = 0;
+		// PlayerInput::EEvent bits
+		uint8 events = 0;
+		// Quantized mouse delta of the input frame, smoothed by whoever simulates it
+		Vec2 lookDelta = ZERO;
+		float frameTime = 0.f;
+
+		void SerializeWith(TSerialize ser)
+		{
+			ser.Value("sequence", sequence);
+			ser.Value("inputFlags", inputFlags);
+			ser.Value("events", events);
+			ser.Value("lookDelta", lookDelta);
+			ser.Value("frameTime", frameTime);
+		}
+	};
+
+	// Reconciled part of the player state
+	struct SMovementState
+	{
+		Vec3 position = ZERO;
+		PlayerSimulation::SLookAngles look;
+		EPlayerState state = ePS_Standing;
+		// PlayerStateMachine condition bits
+		uint8 conditions = PlayerStateMachine::eCondition_CanStand;
+	};
+
+	// Applies the look and state machine steps of a command, the same as PlayerSimulation::SimulateRange
+	// The position is left as it is, it comes from the character controller and can't be reproduced without physics
+	SMovementState Step(const SMovementState& state, const SInputCommand& command, const SGameSettings& settings);
+
+	// Logs commands, acknowledgements, corrections and replayed commands of the real players since the last call
+	void LogStatistics(IConsoleCmdArgs* pArgs);
+
+	// Runs a client and a server over a simulated connection and logs correction rate and re-simulation work
+	// Usage: g_netLoopbackTest [round trip ms = 100] [loss percent = 5] [seconds = 60]
+	void RunLoopbackTest(IConsoleCmdArgs* pArgs);
+}
+
+////////////////////////////////////////////////////////
+// Client side, remembers the commands the server hasn't acknowledged together with the state they were predicted to lead to
+////////////////////////////////////////////////////////
+class CMovementPredictor
+{
+public:
+	// Two seconds of commands at 60 fps, older ones are dropped and can't be replayed anymore
+	static const uint32 MaxPendingCommands = 128;
+	// Every packet repeats the latest unacknowledged commands, so a lost packet doesn't lose input
+	static const uint32 RedundantCommands = 4;
+	// Position difference beyond which the server state is taken over
+	static constexpr float CorrectionDistance = 0.05f;
+
+	struct SStatistics
+	{
+		uint32 commands = 0;
+		uint32 acks = 0;
+		uint32 corrections = 0;
+		// Commands re-simulated after corrections
+		uint32 replayedCommands = 0;
+		// Commands dropped before being acknowledged
+		uint32 overflows = 0;
+		float maxError = 0.f;
+	};
+
+public:
+	uint32 CreateSequence() { return ++m_lastSequence; }
+
+	// Remembers a command applied locally and the state it led to
+	void Record(const MovementPrediction::SInputCommand& command, const MovementPrediction::SMovementState& predicted);
+
+	// Copies the newest unacknowledged commands, oldest first, returns their number
+	uint32 GetCommandsToSend(MovementPrediction::SInputCommand* pCommands, uint32 maxCount) const;
+
+	// Drops the acknowledged commands and compares the server state with the state recorded for the acknowledged command
+	// Returns true if the prediction was off. The state machine of the pending commands is then replayed from the server state,
+	// and the positions recorded for them, the last one being corrected.position, are moved by the position error
+	// Positions are never re-simulated, the recorded ones come from the client's own character controller
+	bool Reconcile(uint32 ackSequence, const MovementPrediction::SMovementState& authoritative, const SGameSettings& settings, MovementPrediction::SMovementState& corrected);
+
+	uint32 GetPendingCount() const { return m_count; }
+	void Reset() { m_first = m_count = 0; }
+
+	static SStatistics s_statistics;
+
+protected:
+	struct SPending
+	{
+		MovementPrediction::SInputCommand command;
+		MovementPrediction::SMovementState predicted;
+	};
+
+	SPending& GetPending(uint32 index) { return m_pending[(m_first + index) % MaxPendingCommands]; }
+	const SPending& GetPending(uint32 index) const { return m_pending[(m_first + index) % MaxPendingCommands]; }
+	void DropFirst(uint32 count) { m_first = (m_first + count) % MaxPendingCommands; m_count -= count; }
+
+protected:
+	SPending m_pending[MaxPendingCommands];
+	uint32 m_first = 0;
+	uint32 m_count = 0;
+	uint32 m_lastSequence = 0;
+};
+
+////////////////////////////////////////////////////////
+// Server side, filters the commands of one client down to the ones not applied yet
+////////////////////////////////////////////////////////
+class CMovementAuthority
+{
+public:
+	struct SStatistics
+	{
+		uint32 accepted = 0;
+		// Repeated commands that were already applied
+		uint32 duplicates = 0;
+		// Commands never received, lost together with all packets repeating them
+		uint32 missed = 0;
+		// Commands applied in the same server step as the one before, e.g. with a client stepping faster than the server
+		uint32 merged = 0;
+		// Commands applied before their time because too many were queued, see CPlayerComponent::MaxQueuedCommands
+		uint32 caughtUp = 0;
+	};
+
+public:
+	// True if the command is newer than all commands applied so far
+	bool Accept(const MovementPrediction::SInputCommand& command);
+
+	uint32 GetLastSequence() const { return m_lastSequence; }
+	void Reset() { m_lastSequence = 0; }
+
+	static SStatistics s_statistics;
+
+protected:
+	uint32 m_lastSequence = 0;
+};
@@ -0,0 +1,125 @@
+#include "StdAfx.h"
+#include "PlayerPool.h"
+
+#include "../Components/Player.h"
+
+#include <CryGame/IGameFramework.h>
+#include <CryNetwork/INetwork.h>
+#include <CrySystem/IConsole.h>
+
+#include <algorithm>
+
+bool CPlayerPool::s_bPrewarming = false;
+
+void CPlayerPool::Prewarm()
+{
+	// Pool size is read from the console on (re)fill, see CUserSettings
+	uint32 poolSize = 0;
+	if (ICVar* pPoolSize = gEnv->pConsole->GetCVar("g_playerPoolSize"))
+	{
+		poolSize = static_cast<uint32>(max(pPoolSize->GetIVal(), 0));
+	}
+
+	s_bPrewarming = true;
+	while (m_entities.size() < poolSize)
+	{
+		const EntityId entityId = CreatePlayer();
+		if (entityId == INVALID_ENTITYID)
+			break;
+
+		m_entities.push_back(entityId);
+		m_idle.push_back(entityId);
+	}
+	s_bPrewarming = false;
+}
+
+void CPlayerPool::Reset()
+{
+	m_entities.clear();
+	m_idle.clear();
+}
+
+IEntity* CPlayerPool::Acquire(int channelId)
+{
+	// Pooled entities are removed with the level (or when leaving game mode in the Editor), forget them in that case
+	if (!m_entities.empty() && gEnv->pEntitySystem->GetEntity(m_entities.front()) == nullptr)
+	{
+		Reset();
+	}
+
+	while (!m_idle.empty())
+	{
+		IEntity* pEntity = gEnv->pEntitySystem->GetEntity(m_idle.back());
+		m_idle.pop_back();
+
+		if (pEntity == nullptr)
+			continue;
+
+		// Same binding as a freshly spawned player, see CGamePlugin::OnClientConnectionReceived
+		// Forced, a returned player was unbound through the net context and its net entity still counts itself as bound
+		pEntity->GetNetEntity()->SetChannelId(channelId);
+		pEntity->GetNetEntity()->BindToNetwork(eBTNM_Force);
+
+		++m_statistics.hits;
+		m_statistics.highWaterMark = max(m_statistics.highWaterMark, GetCapacity() - GetIdleCount());
+		return pEntity;
+	}
+
+	++m_statistics.misses;
+	return nullptr;
+}
+
+bool CPlayerPool::Release(EntityId entityId)
+{
+	if (std::find(m_entities.begin(), m_entities.end(), entityId) == m_entities.end())
+		return false;
+
+	IEntity* pEntity = gEnv->pEntitySystem->GetEntity(entityId);
+	if (pEntity == nullptr)
+	{
+		stl::find_and_erase(m_entities, entityId);
+		return false;
+	}
+
+	// The next client binds the entity again
+	if (INetContext* pNetContext = gEnv->pGameFramework->GetNetContext())
+	{
+		pNetContext->UnbindObject(entityId);
+	}
+	pEntity->GetNetEntity()->SetChannelId(0);
+
+	if (CPlayerComponent* pPlayer = pEntity->GetComponent<CPlayerComponent>())
+	{
+		pPlayer->Deactivate();
+	}
+
+	m_idle.push_back(entityId);
+	++m_statistics.returned;
+	return true;
+}
+
+void CPlayerPool::LogStatistics()
+{
+	CryLogAlways("Player pool: capacity %u, idle %u", GetCapacity(), GetIdleCount());
+	CryLogAlways("    hits %u, misses %u, returned %u, high-water mark %u",
+		m_statistics.hits, m_statistics.misses, m_statistics.returned, m_statistics.highWaterMark);
+
+	m_statistics = SStatistics();
+}
+
+EntityId CPlayerPool::CreatePlayer()
+{
+	SEntitySpawnParams spawnParams;
+	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+	spawnParams.sName = "Player";
+	spawnParams.nFlags |= ENTITY_FLAG_NEVER_NETWORK_STATIC;
+
+	IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams);
+	if (pEntity == nullptr)
+		return INVALID_ENTITYID;
+
+	// Character, Mannequin, input and attachments are set up here, the player deactivates itself while prewarming
+	pEntity->GetOrCreateComponentClass<CPlayerComponent>();
+
+	return pEntity->GetId();
+}
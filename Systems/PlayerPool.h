@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <CryEntitySystem/IEntitySystem.h>
+
+////////////////////////////////////////////////////////
+// Fixed set of fully initialized, hidden player entities spawned on level load
+// Connecting remote clients take a pooled player instead of spawning one, which loads the character and Mannequin data
+// and spawns the attachment entities inside the server tick
+// Disconnecting clients return their player to the pool instead of removing the entity
+////////////////////////////////////////////////////////
+class CPlayerPool
+{
+public:
+	struct SStatistics
+	{
+		// Connections served by a pooled player
+		uint32 hits = 0;
+		// Connections that found the pool empty and spawned a player
+		uint32 misses = 0;
+		uint32 returned = 0;
+		// Highest number of pooled players bound to clients at once
+		uint32 highWaterMark = 0;
+	};
+
+public:
+	// Spawns players until the pool holds the number configured in g_playerPoolSize
+	void Prewarm();
+	// Forgets all pooled players, the entity system removes the entities themselves on level unload
+	void Reset();
+
+	// Binds an idle pooled player to the channel, returns nullptr if the pool is empty
+	// The player stays hidden until it is revived, see CGamePlugin::OnClientReadyForGameplay
+	IEntity* Acquire(int channelId);
+	// Hides the player and takes it back, returns false if the entity doesn't belong to the pool
+	bool Release(EntityId entityId);
+
+	// True while Prewarm spawns players, those wait in the pool instead of reviving on Initialize
+	static bool IsPrewarming() { return s_bPrewarming; }
+
+	uint32 GetCapacity() const { return static_cast<uint32>(m_entities.size()); }
+	uint32 GetIdleCount() const { return static_cast<uint32>(m_idle.size()); }
+
+	void LogStatistics();
+
+protected:
+	EntityId CreatePlayer();
+
+protected:
+	// Every pooled player, bound or idle
+	std::vector<EntityId> m_entities;
+	std::vector<EntityId> m_idle;
+
+	SStatistics m_statistics;
+
+	static bool s_bPrewarming;
+};
@@ -0,0 +1,187 @@
+#include "StdAfx.h"
+#include "PlayerUpdateSystem.h"
+
+#include "../Components/Player.h"
+#include "Profiler.h"
+
+#include <CrySystem/IConsole.h>
+
+#include <algorithm>
+#include <memory>
+
+int CPlayerUpdateSystem::s_enabled = 0;
+
+void CPlayerUpdateSystem::RegisterCVars()
+{
+	ConsoleRegistrationHelper::Register("g_playerBatchUpdate", &s_enabled, 0, VF_RESTRICTEDMODE, "Update all players together in the plugin update, simulating them in parallel jobs\n"
+		"0 = Each player updates itself in ProcessEvent\n"
+		"1 = Batched, recommended for dedicated servers with many players");
+}
+
+void CPlayerUpdateSystem::UnregisterCVars()
+{
+	gEnv->pConsole->UnregisterVariable("g_playerBatchUpdate", true);
+}
+
+void CPlayerUpdateSystem::Register(CPlayerComponent& player)
+{
+	if (std::find(m_players.begin(), m_players.end(), &player) == m_players.end())
+	{
+		m_players.push_back(&player);
+	}
+}
+
+void CPlayerUpdateSystem::Unregister(CPlayerComponent& player)
+{
+	stl::find_and_erase(m_players, &player);
+}
+
+void CPlayerUpdateSystem::Update(float frameTime)
+{
+	if (!IsEnabled() || m_players.empty() || frameTime <= 0.f)
+		return;
+
+	const SGameSettings& settings = CUserSettings::Get();
+	const uint32 count = static_cast<uint32>(m_players.size());
+	m_batch.Resize(count);
+
+	const uint32 steps = m_clock.Advance(frameTime);
+	const float stepTime = m_clock.GetStepTime();
+
+	for (uint32 step = 0; step < steps; ++step)
+	{
+		const CTimeValue gatherStart = gEnv->pTimer->GetAsyncTime();
+		{
+			GAME_PROFILE_SCOPE("PlayerUpdate::Gather");
+			for (uint32 i = 0; i < count; ++i)
+			{
+				m_players[i]->GatherSimulation(m_batch, i, stepTime);
+			}
+		}
+
+		const CTimeValue simulateStart = gEnv->pTimer->GetAsyncTime();
+		{
+			GAME_PROFILE_SCOPE("PlayerUpdate::Simulate");
+			m_statistics.jobs += Simulate(m_batch, settings, stepTime, m_jobStates);
+		}
+
+		const CTimeValue applyStart = gEnv->pTimer->GetAsyncTime();
+		{
+			GAME_PROFILE_SCOPE("PlayerUpdate::Apply");
+			for (uint32 i = 0; i < count; ++i)
+			{
+				m_players[i]->ApplySimulation(m_batch, i, stepTime);
+			}
+		}
+		const CTimeValue applyEnd = gEnv->pTimer->GetAsyncTime();
+
+		m_statistics.gatherTimeMs += (simulateStart - gatherStart).GetMilliSeconds();
+		m_statistics.simulateTimeMs += (applyStart - simulateStart).GetMilliSeconds();
+		m_statistics.applyTimeMs += (applyEnd - applyStart).GetMilliSeconds();
+	}
+
+	// Animation and camera follow the rendered frame, in between the last two steps
+	const CTimeValue frameStart = gEnv->pTimer->GetAsyncTime();
+	{
+		GAME_PROFILE_SCOPE("PlayerUpdate::Frame");
+		for (uint32 i = 0; i < count; ++i)
+		{
+			m_players[i]->UpdateFrame(frameTime, m_clock.GetAlpha());
+		}
+	}
+
+	++m_statistics.frames;
+	m_statistics.steps += steps;
+	m_statistics.playerFrames += count;
+	m_statistics.frameTimeMs += (gEnv->pTimer->GetAsyncTime() - frameStart).GetMilliSeconds();
+}
+
+uint32 CPlayerUpdateSystem::Simulate(PlayerSimulation::SPlayerBatch& batch, const SGameSettings& settings, float frameTime, JobManager::SJobState* pJobStates)
+{
+	const uint32 count = batch.GetCount();
+	const uint32 batchSize = max(MinBatchSize, (count + MaxJobs - 1) / MaxJobs);
+
+	// The calling thread takes the first range itself, the others go to the job system
+	uint32 jobCount = 0;
+	for (uint32 begin = batchSize; begin < count; begin += batchSize)
+	{
+		const uint32 end = min(begin + batchSize, count);
+		PlayerSimulation::SPlayerBatch* pBatch = &batch;
+		const SGameSettings jobSettings = settings;
+		gEnv->pJobManager->AddLambdaJob("PlayerSimulation", [pBatch, begin, end, jobSettings, frameTime]()
+		{
+			PlayerSimulation::SimulateRange(*pBatch, begin, end, jobSettings, frameTime);
+		}, JobManager::eRegularPriority, &pJobStates[jobCount++]);
+	}
+
+	PlayerSimulation::SimulateRange(batch, 0, min(batchSize, count), settings, frameTime);
+
+	for (uint32 i = 0; i < jobCount; ++i)
+	{
+		gEnv->pJobManager->WaitForJob(pJobStates[i]);
+	}
+
+	return jobCount;
+}
+
+void CPlayerUpdateSystem::LogStatistics()
+{
+	const float frames = (float)max(m_statistics.frames, 1u);
+	const float steps = (float)max(m_statistics.steps, 1u);
+	CryLogAlways("Player update: %s, %" PRISIZE_T " players registered, %.1f players and %.2f steps per frame, %.1f jobs per step",
+		IsEnabled() ? "batched" : "per component", m_players.size(), m_statistics.playerFrames / frames, m_statistics.steps / frames, m_statistics.jobs / steps);
+	CryLogAlways("    gather %.3f ms, simulate %.3f ms, apply %.3f ms per step, animation and camera %.3f ms per frame",
+		m_statistics.gatherTimeMs / steps, m_statistics.simulateTimeMs / steps, m_statistics.applyTimeMs / steps, m_statistics.frameTimeMs / frames);
+
+	m_statistics = SStatistics();
+}
+
+void CPlayerUpdateSystem::RunBenchmark(IConsoleCmdArgs* pArgs)
+{
+	const int frameCount = pArgs->GetArgCount() > 1 ? max(atoi(pArgs->GetArg(1)), 1) : 100;
+	const float frameTime = 1.f / 30.f;
+	const SGameSettings& settings = CUserSettings::Get();
+
+	std::unique_ptr<JobManager::SJobState[]> pJobStates(new JobManager::SJobState[MaxJobs]);
+	CRndGen random(0x5eed);
+
+	CryLogAlways("Player update benchmark, %d frames of simulated players without entities", frameCount);
+
+	for (uint32 playerCount = 1; playerCount <= 256; playerCount *= 2)
+	{
+		// Both runs start from the same state and see the same input every frame
+		PlayerSimulation::SPlayerBatch initial;
+		initial.Resize(playerCount);
+		for (uint32 i = 0; i < playerCount; ++i)
+		{
+			initial.inputFlags[i] = static_cast<PlayerSimulation::TInputFlags>(random.GetRandom(0u, 63u));
+			initial.onGround[i] = random.GetRandom(0u, 9u) != 0 ? 1 : 0;
+			initial.lookDeltas[i] = Vec2(random.GetRandom(-20.f, 20.f), random.GetRandom(-20.f, 20.f));
+		}
+
+		PlayerSimulation::SPlayerBatch serial = initial;
+		const CTimeValue serialStart = gEnv->pTimer->GetAsyncTime();
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			PlayerSimulation::SimulateRange(serial, 0, playerCount, settings, frameTime);
+		}
+		const float serialTimeMs = (gEnv->pTimer->GetAsyncTime() - serialStart).GetMilliSeconds();
+
+		PlayerSimulation::SPlayerBatch batched = initial;
+		uint32 jobCount = 0;
+		const CTimeValue batchedStart = gEnv->pTimer->GetAsyncTime();
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			jobCount = Simulate(batched, settings, frameTime, pJobStates.get());
+		}
+		const float batchedTimeMs = (gEnv->pTimer->GetAsyncTime() - batchedStart).GetMilliSeconds();
+
+		// Jobs work on disjoint ranges, the results have to match the serial run exactly
+		const bool bMatches = serial.states == batched.states && serial.conditions == batched.conditions
+			&& memcmp(serial.lookAngles.data(), batched.lookAngles.data(), playerCount * sizeof(PlayerSimulation::SLookAngles)) == 0;
+
+		CryLogAlways("    %3u players: serial %.4f ms/frame, %2u ranges %.4f ms/frame, speedup %.2fx%s", playerCount,
+			serialTimeMs / frameCount, jobCount + 1, batchedTimeMs / frameCount, batchedTimeMs > 0.f ? serialTimeMs / batchedTimeMs : 0.f,
+			bMatches ? "" : " (results differ!)");
+	}
+}
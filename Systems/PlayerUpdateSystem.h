@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include <CryThreading/IJobManager.h>
+
+#include "SimulationClock.h"
+#include "../Components/PlayerSimulation.h"
+
+class CPlayerComponent;
+
+////////////////////////////////////////////////////////
+// Updates all players at once while g_playerBatchUpdate is set, instead of each player in its own ProcessEvent
+// Gathers the hot state of every player into a PlayerSimulation::SPlayerBatch, simulates it in parallel jobs,
+// then applies the results to entities, physics and animation in a serial pass
+// All players share one CSimulationClock, every fixed step runs the three passes and rendered frames update animation and camera once
+////////////////////////////////////////////////////////
+class CPlayerUpdateSystem
+{
+public:
+	// Players per job, fewer players are simulated on the calling thread
+	static const uint32 MinBatchSize = 8;
+	static const uint32 MaxJobs = 32;
+
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		uint32 steps = 0;
+		uint32 playerFrames = 0;
+		uint32 jobs = 0;
+		float gatherTimeMs = 0.f;
+		float simulateTimeMs = 0.f;
+		float applyTimeMs = 0.f;
+		float frameTimeMs = 0.f;
+	};
+
+public:
+	// Bound to g_playerBatchUpdate
+	static bool IsEnabled() { return s_enabled != 0; }
+
+	static void RegisterCVars();
+	static void UnregisterCVars();
+
+	// Players register themselves on Initialize and unregister on destruction
+	void Register(CPlayerComponent& player);
+	void Unregister(CPlayerComponent& player);
+
+	// Updates all registered players when enabled, called once per frame
+	void Update(float frameTime);
+
+	void LogStatistics();
+	// Compares simulating 1 to 256 players on one thread and in jobs, without entities
+	static void RunBenchmark(IConsoleCmdArgs* pArgs);
+
+protected:
+	// Splits the batch into jobs and waits for them, returns the number of jobs started
+	static uint32 Simulate(PlayerSimulation::SPlayerBatch& batch, const SGameSettings& settings, float frameTime, JobManager::SJobState* pJobStates);
+
+protected:
+	std::vector<CPlayerComponent*> m_players;
+	PlayerSimulation::SPlayerBatch m_batch;
+	JobManager::SJobState m_jobStates[MaxJobs];
+	CSimulationClock m_clock;
+
+	SStatistics m_statistics;
+
+	static int s_enabled;
+};
@@ -0,0 +1,306 @@
+#include "StdAfx.h"
+#include "Profiler.h"
+
+#include <CryCore/BitFiddling.h>
+#include <CrySystem/IConsole.h>
+#include <CrySystem/File/ICryPak.h>
+#include <CryThreading/IThreadManager.h>
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(GAME_PROFILER)
+
+namespace
+{
+	const char* const szDefaultTracePath = "%USER%/GameProfile.json";
+
+	std::mutex s_lock;
+	const char* s_markerNames[CProfiler::MaxMarkers] = {};
+	uint32 s_markerCount = 0;
+
+	std::atomic<bool> s_bCapturing { false };
+	int s_captureFramesLeft = 0;
+	string s_capturePath;
+
+	thread_local void* t_pThreadData = nullptr;
+
+	double GetNanosecondsPerTick()
+	{
+		static const double nanosecondsPerTick = 1000000000.0 / (double)CryGetTicksPerSec();
+		return nanosecondsPerTick;
+	}
+}
+
+std::vector<std::unique_ptr<CProfiler::SThreadData>> CProfiler::s_threads;
+
+CProfiler::MarkerId CProfiler::RegisterMarker(const char* szName)
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	for (uint32 i = 0; i < s_markerCount; ++i)
+	{
+		if (strcmp(s_markerNames[i], szName) == 0)
+			return static_cast<MarkerId>(i);
+	}
+
+	// The last slot collects every marker that didn't fit
+	if (s_markerCount == MaxMarkers - 1)
+	{
+		s_markerNames[MaxMarkers - 1] = "Other markers";
+		return static_cast<MarkerId>(MaxMarkers - 1);
+	}
+
+	s_markerNames[s_markerCount] = szName;
+	return static_cast<MarkerId>(s_markerCount++);
+}
+
+CProfiler::SThreadData& CProfiler::GetThreadData()
+{
+	if (t_pThreadData != nullptr)
+		return *static_cast<SThreadData*>(t_pThreadData);
+
+	std::lock_guard<std::mutex> lock(s_lock);
+	s_threads.emplace_back(new SThreadData());
+	s_threads.back()->threadId = static_cast<uint32>(CryGetCurrentThreadId());
+
+	t_pThreadData = s_threads.back().get();
+	return *s_threads.back();
+}
+
+uint32 CProfiler::GetBucket(uint64 durationNs)
+{
+	if (durationNs < 4)
+		return static_cast<uint32>(durationNs);
+
+	// Octave from the highest bit, the two bits below it pick the quarter
+	const uint32 octave = IntegerLog2(durationNs);
+	const uint32 quarter = static_cast<uint32>(durationNs >> (octave - 2)) & 3;
+	return min(octave * 4 + quarter, HistogramBuckets - 1);
+}
+
+uint64 CProfiler::GetBucketStart(uint32 bucket)
+{
+	if (bucket < 8)
+		return bucket < 4 ? bucket : 4;
+
+	const uint32 octave = bucket / 4;
+	return (1ull << octave) + (bucket % 4) * (1ull << (octave - 2));
+}
+
+void CProfiler::AddSample(MarkerId marker, int64 beginTicks, int64 endTicks)
+{
+	SThreadData& data = GetThreadData();
+
+	const uint64 durationNs = static_cast<uint64>((double)max(endTicks - beginTicks, int64(0)) * GetNanosecondsPerTick());
+
+	// Only this thread writes its statistics, plain loads and stores are enough
+	SMarkerStatistics& statistics = data.markers[marker];
+	statistics.count.store(statistics.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	statistics.totalNs.store(statistics.totalNs.load(std::memory_order_relaxed) + durationNs, std::memory_order_relaxed);
+	if (durationNs < statistics.minNs.load(std::memory_order_relaxed))
+		statistics.minNs.store(durationNs, std::memory_order_relaxed);
+	if (durationNs > statistics.maxNs.load(std::memory_order_relaxed))
+		statistics.maxNs.store(durationNs, std::memory_order_relaxed);
+	std::atomic<uint32>& bucket = statistics.buckets[GetBucket(durationNs)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	if (!s_bCapturing.load(std::memory_order_relaxed))
+		return;
+
+	const uint32 sampleIndex = data.sampleCount.load(std::memory_order_relaxed);
+	if (sampleIndex >= MaxCaptureSamples)
+	{
+		data.droppedSamples.store(data.droppedSamples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+
+	SSample& sample = data.samples[sampleIndex];
+	sample.marker = marker;
+	sample.beginTicks = beginTicks;
+	sample.endTicks = endTicks;
+	data.sampleCount.store(sampleIndex + 1, std::memory_order_release);
+}
+
+void CProfiler::Capture(IConsoleCmdArgs* pArgs)
+{
+	if (s_bCapturing.load())
+	{
+		CryLogAlways("Profiler: a capture is already running, %d frames left", s_captureFramesLeft);
+		return;
+	}
+
+	const int frameCount = pArgs->GetArgCount() > 1 ? max(atoi(pArgs->GetArg(1)), 1) : 60;
+	s_capturePath = pArgs->GetArgCount() > 2 ? pArgs->GetArg(2) : szDefaultTracePath;
+	s_captureFramesLeft = frameCount;
+
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+		for (const std::unique_ptr<SThreadData>& pData : s_threads)
+		{
+			pData->sampleCount.store(0, std::memory_order_relaxed);
+			pData->droppedSamples.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	s_bCapturing.store(true);
+	CryLogAlways("Profiler: capturing %d frames", frameCount);
+}
+
+void CProfiler::OnFrameEnd()
+{
+	if (!s_bCapturing.load(std::memory_order_relaxed) || --s_captureFramesLeft > 0)
+		return;
+
+	s_bCapturing.store(false);
+
+	if (!WriteTrace(s_capturePath.c_str()))
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "Profiler: could not write %s", s_capturePath.c_str());
+	}
+}
+
+bool CProfiler::WriteTrace(const char* szPath)
+{
+	char szAdjustedPath[_MAX_PATH];
+	gEnv->pCryPak->AdjustFileName(szPath, szAdjustedPath, ICryPak::FLAGS_FOR_WRITING);
+
+	FILE* pFile = fopen(szAdjustedPath, "w");
+	if (pFile == nullptr)
+		return false;
+
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	// Timestamps are written in microseconds relative to the first sample
+	int64 firstTicks = INT64_MAX;
+	for (const std::unique_ptr<SThreadData>& pData : s_threads)
+	{
+		const uint32 sampleCount = pData->sampleCount.load(std::memory_order_acquire);
+		for (uint32 i = 0; i < sampleCount; ++i)
+		{
+			firstTicks = min(firstTicks, pData->samples[i].beginTicks);
+		}
+	}
+
+	const double microsecondsPerTick = GetNanosecondsPerTick() / 1000.0;
+	uint32 written = 0;
+	uint32 dropped = 0;
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	const char* szSeparator = "";
+
+	for (const std::unique_ptr<SThreadData>& pData : s_threads)
+	{
+		const uint32 sampleCount = pData->sampleCount.load(std::memory_order_acquire);
+		dropped += pData->droppedSamples.load(std::memory_order_relaxed);
+		if (sampleCount == 0)
+			continue;
+
+		const char* szThreadName = gEnv->pThreadManager ? gEnv->pThreadManager->GetThreadName(pData->threadId) : nullptr;
+		fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			szSeparator, pData->threadId, szThreadName != nullptr && szThreadName[0] != '\0' ? szThreadName : "Unnamed");
+		szSeparator = ",\n";
+
+		for (uint32 i = 0; i < sampleCount; ++i)
+		{
+			const SSample& sample = pData->samples[i];
+			fprintf(pFile, "%s{\"name\":\"%s\",\"cat\":\"game\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+				szSeparator, s_markerNames[sample.marker],
+				(double)(sample.beginTicks - firstTicks) * microsecondsPerTick, (double)(sample.endTicks - sample.beginTicks) * microsecondsPerTick,
+				pData->threadId);
+		}
+		written += sampleCount;
+	}
+
+	fprintf(pFile, "\n]}\n");
+	fclose(pFile);
+
+	CryLogAlways("Profiler: wrote %u scopes to %s (%u dropped, raise CProfiler::MaxCaptureSamples if needed)", written, szAdjustedPath, dropped);
+	return true;
+}
+
+void CProfiler::ResetStatistics()
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	for (const std::unique_ptr<SThreadData>& pData : s_threads)
+	{
+		for (SMarkerStatistics& statistics : pData->markers)
+		{
+			statistics.count.store(0, std::memory_order_relaxed);
+			statistics.totalNs.store(0, std::memory_order_relaxed);
+			statistics.minNs.store(UINT64_MAX, std::memory_order_relaxed);
+			statistics.maxNs.store(0, std::memory_order_relaxed);
+			for (std::atomic<uint32>& bucket : statistics.buckets)
+			{
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+void CProfiler::LogStatistics(IConsoleCmdArgs* pArgs)
+{
+	struct SSummary
+	{
+		const char* szName;
+		uint64 count;
+		uint64 totalNs;
+		uint64 minNs;
+		uint64 maxNs;
+		uint64 buckets[HistogramBuckets];
+	};
+
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	// Merge the histograms of all threads, then reset them
+	std::vector<SSummary> summaries(s_markerNames[MaxMarkers - 1] != nullptr ? MaxMarkers : s_markerCount);
+	for (uint32 marker = 0; marker < summaries.size(); ++marker)
+	{
+		SSummary& summary = summaries[marker];
+		summary = SSummary();
+		summary.szName = s_markerNames[marker];
+		summary.minNs = UINT64_MAX;
+
+		for (const std::unique_ptr<SThreadData>& pData : s_threads)
+		{
+			SMarkerStatistics& statistics = pData->markers[marker];
+			summary.count += statistics.count.exchange(0, std::memory_order_relaxed);
+			summary.totalNs += statistics.totalNs.exchange(0, std::memory_order_relaxed);
+			summary.minNs = min(summary.minNs, statistics.minNs.exchange(UINT64_MAX, std::memory_order_relaxed));
+			summary.maxNs = max(summary.maxNs, statistics.maxNs.exchange(0, std::memory_order_relaxed));
+			for (uint32 bucket = 0; bucket < HistogramBuckets; ++bucket)
+			{
+				summary.buckets[bucket] += statistics.buckets[bucket].exchange(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Most expensive markers first
+	std::sort(summaries.begin(), summaries.end(), [](const SSummary& a, const SSummary& b) { return a.totalNs > b.totalNs; });
+
+	CryLogAlways("Profiler: marker statistics since the last g_profileStats, times in microseconds");
+	CryLogAlways("    %-32s %8s %10s %10s %10s %10s %10s", "marker", "count", "total", "min", "mean", "p99", "max");
+	for (const SSummary& summary : summaries)
+	{
+		if (summary.count == 0)
+			continue;
+
+		// The 99th percentile is reported as the lower edge of its bucket, within a quarter octave
+		const uint64 p99Rank = summary.count - summary.count / 100;
+		uint64 cumulative = 0;
+		uint32 p99Bucket = 0;
+		for (; p99Bucket < HistogramBuckets - 1; ++p99Bucket)
+		{
+			cumulative += summary.buckets[p99Bucket];
+			if (cumulative >= p99Rank)
+				break;
+		}
+		const uint64 p99Ns = max(GetBucketStart(p99Bucket), summary.minNs);
+
+		CryLogAlways("    %-32s %8" PRIu64 " %10.1f %10.2f %10.2f %10.2f %10.2f", summary.szName, summary.count,
+			summary.totalNs / 1000.0, summary.minNs / 1000.0, (double)summary.totalNs / summary.count / 1000.0, p99Ns / 1000.0, summary.maxNs / 1000.0);
+	}
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// The gameplay profiler and its markers are compiled out of release builds
+#if !defined(_RELEASE)
+	#define GAME_PROFILER 1
+#endif
+
+#if defined(GAME_PROFILER)
+
+struct IConsoleCmdArgs;
+
+////////////////////////////////////////////////////////
+// Scoped timing markers for gameplay code
+// Every marker feeds a per-marker duration histogram, dumped with g_profileStats
+// g_profileCapture additionally records each scope for a number of frames and writes them as Chrome trace events
+// Samples go into buffers owned by the thread that took them, markers don't lock after the first use on a thread
+// Use through GAME_PROFILE_SCOPE
+////////////////////////////////////////////////////////
+class CProfiler
+{
+public:
+	static const uint32 MaxMarkers = 64;
+	// Log2 buckets with four steps per octave, covers up to about four seconds
+	static const uint32 HistogramBuckets = 128;
+	// Samples recorded per thread during a capture, later samples are dropped
+	static const uint32 MaxCaptureSamples = 1 << 16;
+
+	typedef uint8 MarkerId;
+
+	// Returns the id of a marker name, names have to outlive the profiler
+	static MarkerId RegisterMarker(const char* szName);
+
+	static void AddSample(MarkerId marker, int64 beginTicks, int64 endTicks);
+
+	// Counts captured frames and writes the trace once the requested number of frames is done
+	static void OnFrameEnd();
+
+	static void Capture(IConsoleCmdArgs* pArgs);
+	static void LogStatistics(IConsoleCmdArgs* pArgs);
+	// Clears the histograms without logging them, e.g. before a measured run
+	static void ResetStatistics();
+
+protected:
+	struct SMarkerStatistics
+	{
+		// Only written by the owning thread, atomic so that g_profileStats can read while the thread runs
+		std::atomic<uint32> count { 0 };
+		std::atomic<uint64> totalNs { 0 };
+		std::atomic<uint64> minNs { UINT64_MAX };
+		std::atomic<uint64> maxNs { 0 };
+		std::atomic<uint32> buckets[HistogramBuckets];
+
+		SMarkerStatistics() { for (std::atomic<uint32>& bucket : buckets) bucket.store(0, std::memory_order_relaxed); }
+	};
+
+	struct SSample
+	{
+		MarkerId marker;
+		int64 beginTicks;
+		int64 endTicks;
+	};
+
+	struct SThreadData
+	{
+		uint32 threadId = 0;
+		SMarkerStatistics markers[MaxMarkers];
+		SSample samples[MaxCaptureSamples];
+		std::atomic<uint32> sampleCount { 0 };
+		std::atomic<uint32> droppedSamples { 0 };
+	};
+
+	static SThreadData& GetThreadData();
+	static uint32 GetBucket(uint64 durationNs);
+	// Lower edge of a histogram bucket in nanoseconds
+	static uint64 GetBucketStart(uint32 bucket);
+	static bool WriteTrace(const char* szPath);
+
+protected:
+	// One entry per thread that ever entered a marker, kept until the module is unloaded
+	static std::vector<std::unique_ptr<SThreadData>> s_threads;
+};
+
+// Times the enclosing scope
+class CProfileScope
+{
+public:
+	explicit CProfileScope(CProfiler::MarkerId marker) : m_marker(marker), m_beginTicks(CryGetTicks()) {}
+	~CProfileScope() { CProfiler::AddSample(m_marker, m_beginTicks, CryGetTicks()); }
+
+protected:
+	CProfiler::MarkerId m_marker;
+	int64 m_beginTicks;
+};
+
+	#define GAME_PROFILE_CONCAT_IMPL(a, b) a ## b
+	#define GAME_PROFILE_CONCAT(a, b) GAME_PROFILE_CONCAT_IMPL(a, b)
+	// e.g. GAME_PROFILE_SCOPE("Player::UpdateCamera"); the name is registered on the first pass only
+	#define GAME_PROFILE_SCOPE(szName)                                                                               \
+		static const CProfiler::MarkerId GAME_PROFILE_CONCAT(profileMarker, __LINE__) = CProfiler::RegisterMarker(szName); \
+		CProfileScope GAME_PROFILE_CONCAT(profileScope, __LINE__)(GAME_PROFILE_CONCAT(profileMarker, __LINE__))
+#else
+	#define GAME_PROFILE_SCOPE(szName) do {} while (false)
+#endif
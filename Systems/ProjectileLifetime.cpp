@@ -0,0 +1,91 @@
+#include "StdAfx.h"
+#include "ProjectileLifetime.h"
+
+#include <CrySystem/IConsole.h>
+
+void CProjectileLifetimeManager::Configure()
+{
+	// Lifetime settings are read from the console on (re)fill of the pool, see CUserSettings
+	if (ICVar* pMaxAge = gEnv->pConsole->GetCVar("g_projectileMaxAge"))
+	{
+		m_maxAge = max(pMaxAge->GetFVal(), 0.f);
+	}
+	if (ICVar* pImpactPolicy = gEnv->pConsole->GetCVar("g_projectileImpactPolicy"))
+	{
+		m_impactPolicy = static_cast<EImpactPolicy>(CLAMP(pImpactPolicy->GetIVal(), 0, (int)EImpactPolicy::Last - 1));
+	}
+	if (ICVar* pMaxBounces = gEnv->pConsole->GetCVar("g_projectileMaxBounces"))
+	{
+		m_maxBounces = static_cast<uint32>(CLAMP(pMaxBounces->GetIVal(), 1, ImpactExpired - 1));
+	}
+	if (ICVar* pMaxLive = gEnv->pConsole->GetCVar("g_projectileMaxLive"))
+	{
+		m_maxLive = static_cast<uint32>(max(pMaxLive->GetIVal(), 1));
+	}
+}
+
+void CProjectileLifetimeManager::Reset()
+{
+	m_wheel.Clear();
+	m_bounces.clear();
+
+	m_reclaimedThisPeriod = 0;
+	m_periodTime = 0.f;
+	m_statistics.reclaimRate = 0.f;
+}
+
+void CProjectileLifetimeManager::Track(uint32 handle)
+{
+	if (handle >= m_bounces.size())
+	{
+		m_bounces.resize(handle + 1);
+	}
+
+	m_bounces[handle] = 0;
+	m_wheel.Schedule(handle, m_maxAge);
+}
+
+void CProjectileLifetimeManager::Untrack(uint32 handle)
+{
+	m_wheel.Cancel(handle);
+}
+
+void CProjectileLifetimeManager::OnImpact(uint32 handle)
+{
+	if (!m_wheel.IsScheduled(handle) || m_bounces[handle] == ImpactExpired)
+		return;
+
+	bool bExpire = false;
+
+	switch (m_impactPolicy)
+	{
+	case EImpactPolicy::FirstImpact:
+		bExpire = true;
+		break;
+	case EImpactPolicy::MaxBounces:
+		bExpire = ++m_bounces[handle] >= m_maxBounces;
+		break;
+	default:
+		break;
+	}
+
+	if (bExpire)
+	{
+		// Don't reclaim from within the physics callback, let the next update pick it up instead
+		m_bounces[handle] = ImpactExpired;
+		m_wheel.Schedule(handle, 0.f);
+	}
+}
+
+void CProjectileLifetimeManager::UpdateReclaimRate(float frameTime)
+{
+	m_periodTime += frameTime;
+
+	if (m_periodTime >= 1.f)
+	{
+		m_statistics.reclaimRate = m_reclaimedThisPeriod / m_periodTime;
+
+		m_reclaimedThisPeriod = 0;
+		m_periodTime = 0.f;
+	}
+}
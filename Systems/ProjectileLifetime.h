@@ -0,0 +1,85 @@
+#pragma once
+
+#include "TimingWheel.h"
+
+////////////////////////////////////////////////////////
+// Decides when projectiles in flight expire: maximum age, impacts, and a global cap on live projectiles
+// Expiry goes through a timing wheel so that reclaiming costs O(expired) per frame rather than O(live)
+////////////////////////////////////////////////////////
+class CProjectileLifetimeManager
+{
+public:
+	// When impacts expire a projectile, in addition to the maximum age
+	enum class EImpactPolicy
+	{
+		Ignore = 0,
+		FirstImpact,
+		MaxBounces,
+		Last
+	};
+
+	struct SStatistics
+	{
+		uint32 expiredByAge = 0;
+		uint32 expiredByImpact = 0;
+		uint32 expiredByCap = 0;
+		// Projectiles reclaimed per second, measured over the last full second
+		float reclaimRate = 0.f;
+	};
+
+public:
+	// Reads g_projectileMaxAge, g_projectileImpactPolicy, g_projectileMaxBounces and g_projectileMaxLive
+	void Configure();
+	void Reset();
+
+	// Starts the lifetime of a launched projectile, handles are the owning pool's slot indices
+	void Track(uint32 handle);
+	void Untrack(uint32 handle);
+
+	// Called for each collision of a projectile in flight, queues expiry for the next update according to the impact policy
+	void OnImpact(uint32 handle);
+	// Called when a projectile is reclaimed to respect the live projectile cap
+	void OnCapped() { ++m_statistics.expiredByCap; ++m_reclaimedThisPeriod; }
+
+	// Advances the clock and calls onExpired(handle) for each projectile that reached the end of its life
+	template<typename TCallback>
+	void Update(float frameTime, TCallback&& onExpired)
+	{
+		m_wheel.Advance(frameTime, [this, &onExpired](uint32 handle)
+		{
+			if (m_bounces[handle] == ImpactExpired)
+				++m_statistics.expiredByImpact;
+			else
+				++m_statistics.expiredByAge;
+
+			++m_reclaimedThisPeriod;
+			onExpired(handle);
+		});
+
+		UpdateReclaimRate(frameTime);
+	}
+
+	uint32 GetMaxLive() const { return m_maxLive; }
+	uint32 GetTrackedCount() const { return m_wheel.GetScheduledCount(); }
+	const SStatistics& GetStatistics() const { return m_statistics; }
+
+protected:
+	void UpdateReclaimRate(float frameTime);
+
+protected:
+	// Marks a projectile whose expiry was queued by an impact
+	static constexpr uint8 ImpactExpired = 0xFF;
+
+	CTimingWheel m_wheel;
+	// Collisions per tracked projectile, indexed by handle
+	std::vector<uint8> m_bounces;
+
+	float m_maxAge = 5.f;
+	EImpactPolicy m_impactPolicy = EImpactPolicy::MaxBounces;
+	uint32 m_maxBounces = 3;
+	uint32 m_maxLive = 256;
+
+	SStatistics m_statistics;
+	uint32 m_reclaimedThisPeriod = 0;
+	float m_periodTime = 0.f;
+};
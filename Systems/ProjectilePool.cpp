@@ -0,0 +1,227 @@
+#include "StdAfx.h"
+#include "ProjectilePool.h"
+
+#include "../Components/Bullet.h"
+
+#include <CrySystem/IConsole.h>
+
+void CProjectilePool::Prewarm()
+{
+	// Pool configuration is read from the console on (re)fill, see CUserSettings
+	if (ICVar* pPoolSize = gEnv->pConsole->GetCVar("g_projectilePoolSize"))
+	{
+		m_poolSize = static_cast<uint32>(max(pPoolSize->GetIVal(), 0));
+	}
+	if (ICVar* pOverflowPolicy = gEnv->pConsole->GetCVar("g_projectilePoolOverflow"))
+	{
+		m_overflowPolicy = static_cast<EOverflowPolicy>(CLAMP(pOverflowPolicy->GetIVal(), 0, (int)EOverflowPolicy::Last - 1));
+	}
+
+	m_lifetime.Configure();
+
+	while (m_slots.size() < m_poolSize)
+	{
+		const uint32 slotIndex = CreateSlot();
+		if (slotIndex == InvalidSlot)
+			break;
+
+		m_freeSlots.push_back(slotIndex);
+	}
+}
+
+void CProjectilePool::Reset()
+{
+	m_slots.clear();
+	m_freeSlots.clear();
+
+	m_oldestActive = InvalidSlot;
+	m_newestActive = InvalidSlot;
+	m_activeCount = 0;
+
+	m_lifetime.Reset();
+}
+
+IEntity* CProjectilePool::Spawn(const QuatTS& transform, const Vec3& velocity, float mass)
+{
+	// Respect the cap on live projectiles by reclaiming the oldest one in flight
+	if (m_activeCount >= m_lifetime.GetMaxLive() && m_oldestActive != InvalidSlot)
+	{
+		ReleaseSlot(m_oldestActive);
+		m_lifetime.OnCapped();
+	}
+
+	const uint32 slotIndex = AcquireSlot();
+	if (slotIndex == InvalidSlot)
+		return nullptr;
+
+	SSlot& slot = m_slots[slotIndex];
+	LinkActive(slotIndex);
+	m_lifetime.Track(slotIndex);
+
+	slot.pBullet->Launch(transform, velocity, mass);
+
+	return slot.pBullet->GetEntity();
+}
+
+void CProjectilePool::Release(EntityId projectileId)
+{
+	if (IEntity* pEntity = gEnv->pEntitySystem->GetEntity(projectileId))
+	{
+		if (CBulletComponent* pBullet = pEntity->GetComponent<CBulletComponent>())
+		{
+			if (pBullet->m_poolSlot < m_slots.size() && m_slots[pBullet->m_poolSlot].entityId == projectileId)
+			{
+				ReleaseSlot(pBullet->m_poolSlot);
+			}
+		}
+	}
+}
+
+void CProjectilePool::Update(float frameTime)
+{
+	m_lifetime.Update(frameTime, [this](uint32 slotIndex)
+	{
+		ReleaseSlot(slotIndex);
+	});
+}
+
+void CProjectilePool::LogStatistics() const
+{
+	static const char* szPolicyNames[] = { "grow", "recycle oldest", "drop" };
+
+	CryLogAlways("Projectile pool: capacity %u, active %u, overflow policy %s", GetCapacity(), m_activeCount, szPolicyNames[(int)m_overflowPolicy]);
+	CryLogAlways("    hits %u, misses %u, high-water mark %u, recycled %u, dropped %u",
+		m_statistics.hits, m_statistics.misses, m_statistics.highWaterMark, m_statistics.recycled, m_statistics.dropped);
+
+	const CProjectileLifetimeManager::SStatistics& lifetime = m_lifetime.GetStatistics();
+	CryLogAlways("    live %u (cap %u), reclaimed %.1f/s, expired by age %u, by impact %u, by cap %u",
+		m_activeCount, m_lifetime.GetMaxLive(), lifetime.reclaimRate, lifetime.expiredByAge, lifetime.expiredByImpact, lifetime.expiredByCap);
+}
+
+uint32 CProjectilePool::CreateSlot()
+{
+	SEntitySpawnParams spawnParams;
+	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+	spawnParams.sName = "Projectile";
+	spawnParams.nFlags |= ENTITY_FLAG_NEVER_NETWORK_STATIC;
+
+	IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams);
+	if (pEntity == nullptr)
+		return InvalidSlot;
+
+	// Geometry, material and physics are set up once here, see Bullet.h
+	CBulletComponent* pBullet = pEntity->CreateComponentClass<CBulletComponent>();
+	pBullet->Disarm();
+
+	const uint32 slotIndex = static_cast<uint32>(m_slots.size());
+	pBullet->m_pPool = this;
+	pBullet->m_poolSlot = slotIndex;
+
+	SSlot slot;
+	slot.entityId = pEntity->GetId();
+	slot.pBullet = pBullet;
+	m_slots.push_back(slot);
+
+	return slotIndex;
+}
+
+uint32 CProjectilePool::AcquireSlot()
+{
+	// Pooled entities are removed with the level (or when leaving game mode in the Editor), refill lazily in that case
+	if (!m_slots.empty() && gEnv->pEntitySystem->GetEntity(m_slots.front().entityId) == nullptr)
+	{
+		Reset();
+	}
+	if (m_slots.empty())
+	{
+		Prewarm();
+	}
+
+	if (!m_freeSlots.empty())
+	{
+		const uint32 slotIndex = m_freeSlots.back();
+		m_freeSlots.pop_back();
+
+		++m_statistics.hits;
+		return slotIndex;
+	}
+
+	++m_statistics.misses;
+
+	switch (m_overflowPolicy)
+	{
+	case EOverflowPolicy::Grow:
+		return CreateSlot();
+	case EOverflowPolicy::RecycleOldest:
+	{
+		const uint32 slotIndex = m_oldestActive;
+		if (slotIndex != InvalidSlot)
+		{
+			UnlinkActive(slotIndex);
+			m_lifetime.Untrack(slotIndex);
+			++m_statistics.recycled;
+		}
+		return slotIndex;
+	}
+	case EOverflowPolicy::Drop:
+	default:
+		++m_statistics.dropped;
+		return InvalidSlot;
+	}
+}
+
+void CProjectilePool::ReleaseSlot(uint32 slotIndex)
+{
+	SSlot& slot = m_slots[slotIndex];
+	if (!slot.bActive)
+		return;
+
+	UnlinkActive(slotIndex);
+	m_lifetime.Untrack(slotIndex);
+
+	// The entity may already be gone with the level or the Editor's game mode, AcquireSlot refills the pool then
+	if (gEnv->pEntitySystem->GetEntity(slot.entityId) == nullptr)
+		return;
+
+	slot.pBullet->Disarm();
+	m_freeSlots.push_back(slotIndex);
+}
+
+void CProjectilePool::LinkActive(uint32 slotIndex)
+{
+	SSlot& slot = m_slots[slotIndex];
+	slot.bActive = true;
+	slot.previous = m_newestActive;
+	slot.next = InvalidSlot;
+
+	if (m_newestActive != InvalidSlot)
+		m_slots[m_newestActive].next = slotIndex;
+	else
+		m_oldestActive = slotIndex;
+
+	m_newestActive = slotIndex;
+
+	++m_activeCount;
+	m_statistics.highWaterMark = max(m_statistics.highWaterMark, m_activeCount);
+}
+
+void CProjectilePool::UnlinkActive(uint32 slotIndex)
+{
+	SSlot& slot = m_slots[slotIndex];
+	slot.bActive = false;
+
+	if (slot.previous != InvalidSlot)
+		m_slots[slot.previous].next = slot.next;
+	else
+		m_oldestActive = slot.next;
+
+	if (slot.next != InvalidSlot)
+		m_slots[slot.next].previous = slot.previous;
+	else
+		m_newestActive = slot.previous;
+
+	slot.previous = InvalidSlot;
+	slot.next = InvalidSlot;
+
+	--m_activeCount;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include <CryEntitySystem/IEntitySystem.h>
+
+#include "ProjectileLifetime.h"
+
+class CBulletComponent;
+
+////////////////////////////////////////////////////////
+// Fixed set of pre-spawned, pre-physicalized bullet entities
+// Shots take a bullet from the pool and re-arm it, instead of spawning and physicalizing a new entity every time
+// Projectiles return to the pool when CProjectileLifetimeManager expires them
+////////////////////////////////////////////////////////
+class CProjectilePool
+{
+public:
+	// What to do when a projectile is requested while every pooled one is in flight
+	enum class EOverflowPolicy
+	{
+		Grow = 0,
+		RecycleOldest,
+		Drop,
+		Last
+	};
+
+	struct SStatistics
+	{
+		// Spawns served by an idle pooled projectile
+		uint32 hits = 0;
+		// Spawns that found no idle projectile and went through the overflow policy
+		uint32 misses = 0;
+		// Highest number of projectiles in flight at once
+		uint32 highWaterMark = 0;
+		uint32 recycled = 0;
+		uint32 dropped = 0;
+	};
+
+	static constexpr uint32 InvalidSlot = ~0u;
+
+public:
+	CProjectilePool() = default;
+
+	// Spawns projectiles until the pool holds the number configured in g_projectilePoolSize
+	void Prewarm();
+	// Forgets all pooled projectiles, the entity system removes the entities themselves on level unload
+	void Reset();
+
+	// Takes a projectile from the pool and launches it with a velocity in m/s, returns nullptr if the overflow policy dropped the request
+	IEntity* Spawn(const QuatTS& transform, const Vec3& velocity, float mass);
+	// Returns a projectile to the pool
+	void Release(EntityId projectileId);
+
+	// Reclaims expired projectiles, called once per frame
+	void Update(float frameTime);
+	// Called by pooled bullets when they collide with something
+	void OnImpact(uint32 slotIndex) { m_lifetime.OnImpact(slotIndex); }
+
+	uint32 GetCapacity() const { return static_cast<uint32>(m_slots.size()); }
+	uint32 GetActiveCount() const { return m_activeCount; }
+	const SStatistics& GetStatistics() const { return m_statistics; }
+
+	void LogStatistics() const;
+
+protected:
+	struct SSlot
+	{
+		EntityId entityId = INVALID_ENTITYID;
+		CBulletComponent* pBullet = nullptr;
+		bool bActive = false;
+
+		// Active projectiles are kept in a list ordered by launch time, so that the oldest can be recycled in constant time
+		uint32 previous = InvalidSlot;
+		uint32 next = InvalidSlot;
+	};
+
+	uint32 CreateSlot();
+	uint32 AcquireSlot();
+	void ReleaseSlot(uint32 slotIndex);
+
+	void LinkActive(uint32 slotIndex);
+	void UnlinkActive(uint32 slotIndex);
+
+protected:
+	std::vector<SSlot> m_slots;
+	std::vector<uint32> m_freeSlots;
+
+	uint32 m_oldestActive = InvalidSlot;
+	uint32 m_newestActive = InvalidSlot;
+	uint32 m_activeCount = 0;
+
+	uint32 m_poolSize = 64;
+	EOverflowPolicy m_overflowPolicy = EOverflowPolicy::RecycleOldest;
+
+	SStatistics m_statistics;
+
+	CProjectileLifetimeManager m_lifetime;
+};
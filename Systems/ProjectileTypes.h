@@ -0,0 +1,20 @@
+#pragma once
+
+// Projectiles launched through CGamePlugin::LaunchProjectile
+// Launch velocities are in m/s in both modes, pooled rigid bodies get them set directly and analytic ones integrate them
+namespace Projectile
+{
+	enum class EType : uint8
+	{
+		Bullet = 0,
+		Stone,
+		Count
+	};
+
+	// Mass in kg, pooled rigid bodies are simulated with it and impacts push and damage with it
+	inline float GetMass(EType type)
+	{
+		static const float masses[(size_t)EType::Count] = { 0.25f, 1.0f };
+		return masses[(size_t)type];
+	}
+}
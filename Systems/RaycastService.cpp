@@ -0,0 +1,415 @@
+#include "StdAfx.h"
+#include "RaycastService.h"
+
+#include <CryEntitySystem/IEntitySystem.h>
+
+////////////////////////////////////////////////////////
+// CEngineRaycastBackend
+////////////////////////////////////////////////////////
+void CEngineRaycastBackend::Submit(const SRayRequest& request, uint32 ticket)
+{
+	SPendingRay& pending = m_pending[ticket % MaxPendingRays];
+
+	{
+		CryAutoCriticalSection lock(m_lock);
+
+		// Too many rays in flight, fall back to a blocking query for this one
+		if (pending.bPending)
+		{
+			ray_hit hit;
+			IPhysicalEntity* pSkipEntities[2] = { request.pSkipEntities[0], request.pSkipEntities[1] };
+			const int hitCount = gEnv->pPhysicalWorld->RayWorldIntersection(request.origin, request.direction, request.objectTypes, request.flags, &hit, 1, pSkipEntities, request.skipEntityCount);
+
+			m_completed.emplace_back(ticket, ToResult(&hit, hitCount));
+			return;
+		}
+
+		pending.bPending = true;
+	}
+
+	pending.pSkipEntities[0] = request.pSkipEntities[0];
+	pending.pSkipEntities[1] = request.pSkipEntities[1];
+
+	SRWIParams params;
+	params.org = request.origin;
+	params.dir = request.direction;
+	params.objtypes = request.objectTypes;
+	params.flags = request.flags | rwi_queue;
+	params.hits = &pending.hit;
+	params.nMaxHits = 1;
+	params.pSkipEnts = pending.pSkipEntities;
+	params.nSkipEnts = request.skipEntityCount;
+	params.OnEvent = &CEngineRaycastBackend::OnRayWorldIntersectionResult;
+	params.pForeignData = this;
+	params.iForeignData = static_cast<int>(ticket);
+
+	gEnv->pPhysicalWorld->RayWorldIntersection(params, "RaycastService");
+}
+
+void CEngineRaycastBackend::Poll(const std::function<void(uint32 ticket, const SRayResult& result)>& onCompleted)
+{
+	CryAutoCriticalSection lock(m_lock);
+
+	for (const std::pair<uint32, SRayResult>& completed : m_completed)
+	{
+		onCompleted(completed.first, completed.second);
+	}
+
+	m_completed.clear();
+}
+
+int CEngineRaycastBackend::OnRayWorldIntersectionResult(const EventPhysRWIResult* pEvent)
+{
+	// May be called from the physics thread
+	CEngineRaycastBackend* pBackend = static_cast<CEngineRaycastBackend*>(pEvent->pForeignData);
+	const uint32 ticket = static_cast<uint32>(pEvent->iForeignData);
+
+	CryAutoCriticalSection lock(pBackend->m_lock);
+
+	pBackend->m_completed.emplace_back(ticket, ToResult(pEvent->pHits, pEvent->nHits));
+	pBackend->m_pending[ticket % MaxPendingRays].bPending = false;
+
+	return 1;
+}
+
+SRayResult CEngineRaycastBackend::ToResult(const ray_hit* pHit, int hitCount)
+{
+	SRayResult result;
+
+	if (hitCount > 0 && pHit != nullptr && pHit->pCollider != nullptr)
+	{
+		result.bHit = true;
+		result.point = pHit->pt;
+		result.normal = pHit->n;
+		result.distance = pHit->dist;
+		result.surfaceId = pHit->surface_idx;
+		result.pCollider = pHit->pCollider;
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////
+// CStubRaycastBackend
+////////////////////////////////////////////////////////
+void CStubRaycastBackend::Submit(const SRayRequest& request, uint32 ticket)
+{
+	const float length = request.direction.GetLength();
+	const Vec3 direction = length > 0.f ? request.direction / length : Vec3(ZERO);
+
+	SRayResult result;
+	result.distance = length;
+
+	auto considerHit = [&](float distance, const Vec3& normal)
+	{
+		if (distance >= 0.f && distance <= result.distance)
+		{
+			result.bHit = true;
+			result.distance = distance;
+			result.point = request.origin + direction * distance;
+			result.normal = normal;
+		}
+	};
+
+	for (const SPlane& plane : m_planes)
+	{
+		const float denominator = plane.normal.Dot(direction);
+		if (fabsf(denominator) > FLT_EPSILON)
+		{
+			considerHit((plane.distance - plane.normal.Dot(request.origin)) / denominator, plane.normal);
+		}
+	}
+
+	for (const SSphere& sphere : m_spheres)
+	{
+		const Vec3 toOrigin = request.origin - sphere.center;
+		const float b = toOrigin.Dot(direction);
+		const float c = toOrigin.GetLengthSquared() - sphere.radius * sphere.radius;
+		const float discriminant = b * b - c;
+		if (discriminant >= 0.f)
+		{
+			const float distance = -b - sqrtf(discriminant);
+			considerHit(distance, (toOrigin + direction * distance).GetNormalizedSafe());
+		}
+	}
+
+	if (!result.bHit)
+	{
+		result.distance = 0.f;
+	}
+
+	if (m_lostRayInterval != 0 && ++m_submitted % m_lostRayInterval == 0)
+		return;
+
+	m_completed.emplace_back(ticket, result);
+}
+
+void CStubRaycastBackend::Poll(const std::function<void(uint32 ticket, const SRayResult& result)>& onCompleted)
+{
+	if (m_bReverseCompletion)
+	{
+		std::reverse(m_completed.begin(), m_completed.end());
+	}
+
+	for (const std::pair<uint32, SRayResult>& completed : m_completed)
+	{
+		onCompleted(completed.first, completed.second);
+	}
+
+	m_completed.clear();
+}
+
+////////////////////////////////////////////////////////
+// CRaycastService
+////////////////////////////////////////////////////////
+CRaycastService::CRaycastService()
+	: m_pBackend(new CEngineRaycastBackend())
+{
+}
+
+void CRaycastService::Submit(SRayRequest&& request)
+{
+	m_queued.emplace_back(std::move(request));
+}
+
+void CRaycastService::Cancel(const void* pOwner)
+{
+	m_queued.erase(std::remove_if(m_queued.begin(), m_queued.end(), [pOwner](const SRayRequest& request) { return request.pOwner == pOwner; }), m_queued.end());
+
+	// Rays already sent keep their ticket, only make sure nothing gets delivered to the owner
+	for (SInFlight& inFlight : m_inFlight)
+	{
+		if (inFlight.request.pOwner == pOwner)
+		{
+			inFlight.request.pResult = nullptr;
+			inFlight.request.callback = nullptr;
+		}
+	}
+}
+
+void CRaycastService::Update()
+{
+	++m_frame;
+	Deliver();
+	Flush();
+}
+
+void CRaycastService::Reset()
+{
+	m_queued.clear();
+
+	// Results still in flight will be ignored
+	m_firstTicket += static_cast<uint32>(m_inFlight.size());
+	m_inFlight.clear();
+}
+
+void CRaycastService::LogStatistics() const
+{
+	CryLogAlways("Raycast service: %u rays submitted, %u delivered last frame, %u in flight, %u timed out so far",
+		m_statistics.raysSubmitted, m_statistics.raysDelivered, m_statistics.raysInFlight, m_statistics.raysTimedOut);
+	CryLogAlways("    submit %.3f ms, deliver %.3f ms", m_statistics.submitTimeMs, m_statistics.deliverTimeMs);
+}
+
+void CRaycastService::Deliver()
+{
+	const CTimeValue start = gEnv->pTimer->GetAsyncTime();
+
+	m_pBackend->Poll([this](uint32 ticket, const SRayResult& result)
+	{
+		const uint32 index = ticket - m_firstTicket;
+		if (index < m_inFlight.size())
+		{
+			m_inFlight[index].result = result;
+			m_inFlight[index].bCompleted = true;
+		}
+	});
+
+	// Deliver in submission order, a ray that hasn't completed yet holds back the ones after it until it times out
+	uint32 delivered = 0;
+	while (!m_inFlight.empty())
+	{
+		SInFlight& inFlight = m_inFlight.front();
+
+		if (!inFlight.bCompleted)
+		{
+			if (m_frame - inFlight.frame < MaxFramesInFlight)
+				break;
+
+			// A late result has a ticket before m_firstTicket and is ignored by the poll above
+			// Deliver a miss, so that the owner doesn't keep a hit of an older ray
+			++m_statistics.raysTimedOut;
+			inFlight.result = SRayResult();
+		}
+		else if (inFlight.result.pCollider != nullptr)
+		{
+			IEntity* pEntity = gEnv->pEntitySystem->GetEntityFromPhysics(inFlight.result.pCollider);
+			inFlight.result.entityId = pEntity != nullptr ? pEntity->GetId() : INVALID_ENTITYID;
+		}
+		inFlight.result.pCollider = nullptr;
+
+		if (inFlight.request.pResult != nullptr)
+		{
+			*inFlight.request.pResult = inFlight.result;
+		}
+		if (inFlight.request.callback)
+		{
+			inFlight.request.callback(inFlight.result);
+		}
+
+		m_inFlight.pop_front();
+		++m_firstTicket;
+		++delivered;
+	}
+
+	m_statistics.raysDelivered = delivered;
+	m_statistics.deliverTimeMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+}
+
+void CRaycastService::Flush()
+{
+	const CTimeValue start = gEnv->pTimer->GetAsyncTime();
+
+	for (SRayRequest& request : m_queued)
+	{
+		const uint32 ticket = m_firstTicket + static_cast<uint32>(m_inFlight.size());
+
+		m_inFlight.emplace_back();
+		m_inFlight.back().request = std::move(request);
+		m_inFlight.back().frame = m_frame;
+
+		m_pBackend->Submit(m_inFlight.back().request, ticket);
+	}
+
+	m_statistics.raysSubmitted = static_cast<uint32>(m_queued.size());
+	m_statistics.raysInFlight = static_cast<uint32>(m_inFlight.size());
+	m_statistics.submitTimeMs = (gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds();
+
+	m_queued.clear();
+}
+
+void CRaycastService::RunSelfTest(IConsoleCmdArgs* pArgs)
+{
+	const uint32 raysPerFrame = pArgs->GetArgCount() > 1 ? static_cast<uint32>(max(atoi(pArgs->GetArg(1)), 1)) : 256;
+	const uint32 frames = pArgs->GetArgCount() > 2 ? static_cast<uint32>(max(atoi(pArgs->GetArg(2)), 1)) : 100;
+
+	// Rays go straight down onto a ground plane at z = 0 from a height that encodes their submission index
+	auto createRequest = [](uint32 index, const void* pOwner, std::vector<uint32>& deliveries)
+	{
+		SRayRequest request;
+		request.origin = Vec3(0.f, 0.f, 1.f + index);
+		request.direction = Vec3(0.f, 0.f, -1000.f);
+		request.pOwner = pOwner;
+		request.callback = [index, &deliveries](const SRayResult& result)
+		{
+			// Record a wrong hit as an out of order delivery
+			deliveries.push_back(result.bHit && fabsf(result.distance - (1.f + index)) < 0.01f ? index : ~0u);
+		};
+		return request;
+	};
+
+	auto createService = [](bool bReverseCompletion, uint32 lostRayInterval)
+	{
+		CStubRaycastBackend* pBackend = new CStubRaycastBackend();
+		pBackend->m_planes.push_back({ Vec3(0.f, 0.f, 1.f), 0.f });
+		pBackend->m_bReverseCompletion = bReverseCompletion;
+		pBackend->m_lostRayInterval = lostRayInterval;
+
+		std::unique_ptr<CRaycastService> pService(new CRaycastService());
+		pService->SetBackend(std::unique_ptr<IRaycastBackend>(pBackend));
+		return pService;
+	};
+
+	uint32 failures = 0;
+	auto check = [&failures](bool bPassed, const char* szName)
+	{
+		CryLogAlways("    %s: %s", bPassed ? "passed" : "FAILED", szName);
+		failures += bPassed ? 0 : 1;
+	};
+
+	CryLogAlways("Raycast self test");
+
+	// Batching and ordering, results completing in reverse come out in submission order the update after the submit
+	{
+		std::unique_ptr<CRaycastService> pService = createService(true, 0);
+		std::vector<uint32> deliveries;
+		const uint32 count = 64;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			pService->Submit(createRequest(i, nullptr, deliveries));
+		}
+
+		pService->Update();
+		check(deliveries.empty() && pService->GetStatistics().raysSubmitted == count, "rays of a frame are sent as one batch and not delivered in the same update");
+
+		pService->Update();
+		bool bInOrder = deliveries.size() == count;
+		for (uint32 i = 0; bInOrder && i < count; ++i)
+		{
+			bInOrder = deliveries[i] == i;
+		}
+		check(bInOrder, "results completed in reverse are delivered in submission order with the right hits");
+	}
+
+	// Cancelling, neither the queued nor the sent rays of the owner are delivered
+	{
+		std::unique_ptr<CRaycastService> pService = createService(false, 0);
+		std::vector<uint32> deliveries;
+		const int owners[2] = {};
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			pService->Submit(createRequest(i, &owners[i % 2], deliveries));
+		}
+		pService->Update();
+		pService->Submit(createRequest(8, &owners[0], deliveries));
+		pService->Cancel(&owners[0]);
+		pService->Update();
+		pService->Update();
+
+		check(deliveries.size() == 4 && deliveries[0] == 1 && deliveries[3] == 7, "rays of a cancelled owner are not delivered");
+	}
+
+	// Timeouts, a ray that never completes holds back the ones after it for MaxFramesInFlight updates only
+	{
+		std::unique_ptr<CRaycastService> pService = createService(false, 4);
+		std::vector<uint32> deliveries;
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			pService->Submit(createRequest(i, nullptr, deliveries));
+		}
+
+		uint32 updates = 0;
+		while (deliveries.size() < 8 && updates < MaxFramesInFlight * 4)
+		{
+			pService->Update();
+			++updates;
+		}
+
+		// The lost rays 3 and 7 come out as misses, recorded as out of order deliveries
+		check(deliveries.size() == 8 && deliveries[3] == ~0u && deliveries[7] == ~0u && deliveries[4] == 4
+			&& pService->GetStatistics().raysTimedOut == 2 && updates == MaxFramesInFlight + 1,
+			"rays that never complete are delivered as a miss after MaxFramesInFlight updates");
+	}
+
+	// Service overhead on top of the backend, rays are answered right away by the stub
+	{
+		std::unique_ptr<CRaycastService> pService = createService(false, 0);
+		std::vector<uint32> deliveries;
+		deliveries.reserve(raysPerFrame);
+
+		const int64 startTicks = CryGetTicks();
+		for (uint32 frame = 0; frame < frames; ++frame)
+		{
+			deliveries.clear();
+			for (uint32 i = 0; i < raysPerFrame; ++i)
+			{
+				pService->Submit(createRequest(i, nullptr, deliveries));
+			}
+			pService->Update();
+		}
+		const double ms = (CryGetTicks() - startTicks) * 1000.0 / (double)CryGetTicksPerSec();
+
+		CryLogAlways("    %u frames of %u rays: %.3f ms per frame, %.3f us per ray", frames, raysPerFrame, ms / frames, ms * 1000.0 / (frames * raysPerFrame));
+	}
+
+	CryLogAlways("Raycast self test %s, %u checks failed", failures == 0 ? "passed" : "FAILED", failures);
+}
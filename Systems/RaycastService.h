@@ -0,0 +1,190 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <CryThreading/CryThread.h>
+
+struct IConsoleCmdArgs;
+
+struct SRayResult
+{
+	bool bHit = false;
+	Vec3 point = ZERO;
+	Vec3 normal = ZERO;
+	float distance = 0.f;
+	int surfaceId = 0;
+	// Entity that was hit, resolved on the main thread when the result is delivered
+	EntityId entityId = INVALID_ENTITYID;
+	// Only set between the backend and the service, cleared before the result is delivered since the collider may be gone by then
+	IPhysicalEntity* pCollider = nullptr;
+};
+
+struct SRayRequest
+{
+	Vec3 origin = ZERO;
+	// Direction scaled by the length of the ray
+	Vec3 direction = ZERO;
+	int objectTypes = ent_all;
+	unsigned int flags = rwi_stop_at_pierceable | rwi_colltype_any;
+
+	IPhysicalEntity* pSkipEntities[2] = { nullptr, nullptr };
+	int skipEntityCount = 0;
+
+	// Requests are tagged with their owner so that they can be cancelled when it goes away
+	const void* pOwner = nullptr;
+	// Written when the result is delivered, may be combined with a callback
+	SRayResult* pResult = nullptr;
+	std::function<void(const SRayResult&)> callback;
+};
+
+////////////////////////////////////////////////////////
+// Executes batches of rays, results may complete asynchronously and in any order
+////////////////////////////////////////////////////////
+struct IRaycastBackend
+{
+	virtual ~IRaycastBackend() {}
+
+	// Starts a ray, the result is reported with the same ticket from a later Poll
+	virtual void Submit(const SRayRequest& request, uint32 ticket) = 0;
+	// Reports all results completed since the last call
+	virtual void Poll(const std::function<void(uint32 ticket, const SRayResult& result)>& onCompleted) = 0;
+};
+
+////////////////////////////////////////////////////////
+// Physics backed rays, queued to the physics thread with rwi_queue
+////////////////////////////////////////////////////////
+class CEngineRaycastBackend final : public IRaycastBackend
+{
+public:
+	// IRaycastBackend
+	virtual void Submit(const SRayRequest& request, uint32 ticket) override;
+	virtual void Poll(const std::function<void(uint32 ticket, const SRayResult& result)>& onCompleted) override;
+	// ~IRaycastBackend
+
+protected:
+	// Storage that has to stay valid while the physics thread processes a queued ray
+	struct SPendingRay
+	{
+		ray_hit hit;
+		IPhysicalEntity* pSkipEntities[2];
+		bool bPending = false;
+	};
+
+	static const uint32 MaxPendingRays = 1024;
+
+	static int OnRayWorldIntersectionResult(const EventPhysRWIResult* pEvent);
+	static SRayResult ToResult(const ray_hit* pHit, int hitCount);
+
+protected:
+	CryCriticalSection m_lock;
+	SPendingRay m_pending[MaxPendingRays];
+	std::vector<std::pair<uint32, SRayResult>> m_completed;
+};
+
+////////////////////////////////////////////////////////
+// Physics-free backend resolving rays against a list of planes and spheres
+// Completes every ray on the next Poll, used to exercise batching and ordering without a physics world
+////////////////////////////////////////////////////////
+class CStubRaycastBackend final : public IRaycastBackend
+{
+public:
+	struct SSphere
+	{
+		Vec3 center;
+		float radius;
+	};
+
+	struct SPlane
+	{
+		Vec3 normal;
+		float distance;
+	};
+
+	// IRaycastBackend
+	virtual void Submit(const SRayRequest& request, uint32 ticket) override;
+	virtual void Poll(const std::function<void(uint32 ticket, const SRayResult& result)>& onCompleted) override;
+	// ~IRaycastBackend
+
+	std::vector<SSphere> m_spheres;
+	std::vector<SPlane> m_planes;
+
+	// Report results in reverse order, to check that the service restores submission order
+	bool m_bReverseCompletion = false;
+	// Every nth ray never completes, to check that the service skips it, 0 completes all
+	uint32 m_lostRayInterval = 0;
+
+protected:
+	std::vector<std::pair<uint32, SRayResult>> m_completed;
+	uint32 m_submitted = 0;
+};
+
+////////////////////////////////////////////////////////
+// Central service for gameplay rays
+// Requests submitted during a frame are sent to the backend as one batch, results are delivered the next frame in submission order
+// A ray the backend hasn't answered after MaxFramesInFlight updates is delivered as a miss
+////////////////////////////////////////////////////////
+class CRaycastService
+{
+public:
+	static const uint32 MaxFramesInFlight = 4;
+
+	struct SStatistics
+	{
+		uint32 raysSubmitted = 0;
+		uint32 raysDelivered = 0;
+		uint32 raysInFlight = 0;
+		// Rays delivered as a miss since the start, see MaxFramesInFlight
+		uint32 raysTimedOut = 0;
+		float submitTimeMs = 0.f;
+		float deliverTimeMs = 0.f;
+	};
+
+public:
+	CRaycastService();
+
+	void SetBackend(std::unique_ptr<IRaycastBackend> pBackend) { m_pBackend = std::move(pBackend); }
+	IRaycastBackend* GetBackend() const { return m_pBackend.get(); }
+
+	// Queues a ray for the current frame's batch
+	void Submit(SRayRequest&& request);
+	// Drops pending requests of the owner, results won't be delivered anymore
+	void Cancel(const void* pOwner);
+
+	// Delivers results of previous batches, then sends the requests queued this frame as a new batch
+	void Update();
+	void Reset();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void LogStatistics() const;
+
+	// Checks batching, ordering, cancelling and timeouts against CStubRaycastBackend and times the service overhead
+	// Usage: g_raycastSelfTest [rays per frame = 256] [frames = 100]
+	static void RunSelfTest(IConsoleCmdArgs* pArgs);
+
+protected:
+	struct SInFlight
+	{
+		SRayRequest request;
+		SRayResult result;
+		// Update that sent the ray to the backend
+		uint32 frame = 0;
+		bool bCompleted = false;
+	};
+
+	void Deliver();
+	void Flush();
+
+protected:
+	std::unique_ptr<IRaycastBackend> m_pBackend;
+
+	std::vector<SRayRequest> m_queued;
+	// Requests sent to the backend, indexed by ticket - m_firstTicket
+	std::deque<SInFlight> m_inFlight;
+	uint32 m_firstTicket = 0;
+	uint32 m_frame = 0;
+
+	SStatistics m_statistics;
+};
@@ -0,0 +1,182 @@
+#include "StdAfx.h"
+#include "SessionRecorder.h"
+
+#include "../UserSettings.h"
+
+#include <CrySystem/File/ICryPak.h>
+#include <CrySystem/IConsole.h>
+
+CSessionRecorder* CSessionRecorder::s_pActive = nullptr;
+
+bool CSessionRecorder::Start(const char* szPath)
+{
+	if (m_pFile != nullptr)
+		return true;
+
+	char szAdjustedPath[_MAX_PATH];
+	gEnv->pCryPak->AdjustFileName(szPath, szAdjustedPath, ICryPak::FLAGS_FOR_WRITING);
+
+	m_pFile = fopen(szAdjustedPath, "wb");
+	if (m_pFile == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "Session recorder: could not open %s for writing", szAdjustedPath);
+		return false;
+	}
+
+	const SGameSettings& settings = CUserSettings::Get();
+	const ICVar* pMaxAge = gEnv->pConsole->GetCVar("g_projectileMaxAge");
+	const ICVar* pTickRate = gEnv->pConsole->GetCVar("g_playerTickRate");
+	const ICVar* pMaxTicks = gEnv->pConsole->GetCVar("g_playerMaxTicksPerFrame");
+
+	SessionRecording::SFileHeader header = {};
+	header.magic = SessionRecording::FileMagic;
+	header.version = SessionRecording::FileVersion;
+	header.recordSize = sizeof(SessionRecording::SRecord);
+	header.walkSpeed = settings.walkSpeed;
+	header.crouchSpeed = settings.crouchSpeed;
+	header.rotationSpeed = settings.rotationSpeed;
+	header.minPitch = settings.minPitch;
+	header.maxPitch = settings.maxPitch;
+	header.projectileMaxAge = pMaxAge ? pMaxAge->GetFVal() : 5.f;
+	header.tickRate = pTickRate ? pTickRate->GetIVal() : 0;
+	header.maxTicksPerFrame = pMaxTicks ? pMaxTicks->GetIVal() : 1;
+	header.mouseFilter = settings.mouseFilter;
+	header.mouseFilterTimeConstant = settings.mouseFilterTimeConstant;
+	header.mouseFilterMinCutoff = settings.mouseFilterMinCutoff;
+	header.mouseFilterBeta = settings.mouseFilterBeta;
+	fwrite(&header, sizeof(header), 1, m_pFile);
+
+	m_buffer.reserve(BufferCapacity);
+	m_buffer.clear();
+	m_statistics = SStatistics();
+	m_statistics.bytesWritten = sizeof(header);
+
+	s_pActive = this;
+
+	CryLog("Session recorder: recording to %s", szAdjustedPath);
+	return true;
+}
+
+void CSessionRecorder::Stop()
+{
+	if (m_pFile == nullptr)
+		return;
+
+	s_pActive = nullptr;
+
+	Flush();
+	fclose(m_pFile);
+	m_pFile = nullptr;
+
+	LogStatistics();
+}
+
+SessionRecording::SRecord* CSessionRecorder::Append(SessionRecording::ERecord type, EntityId entityId)
+{
+	CSessionRecorder* pRecorder = s_pActive;
+	if (pRecorder == nullptr)
+		return nullptr;
+
+	if (pRecorder->m_buffer.size() >= BufferCapacity)
+	{
+		pRecorder->Flush();
+	}
+
+	pRecorder->m_buffer.emplace_back();
+	SessionRecording::SRecord& record = pRecorder->m_buffer.back();
+	memset(&record, 0, sizeof(record));
+	record.type = static_cast<uint8_t>(type);
+	record.entityId = entityId;
+
+	++pRecorder->m_statistics.records;
+	return &record;
+}
+
+void CSessionRecorder::Flush()
+{
+	if (m_buffer.empty())
+		return;
+
+	fwrite(m_buffer.data(), sizeof(SessionRecording::SRecord), m_buffer.size(), m_pFile);
+	fflush(m_pFile);
+
+	m_statistics.bytesWritten += m_buffer.size() * sizeof(SessionRecording::SRecord);
+	m_buffer.clear();
+}
+
+void CSessionRecorder::RecordFrame(float frameTime)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Frame, INVALID_ENTITYID))
+	{
+		pRecord->values[0] = frameTime;
+		++s_pActive->m_statistics.frames;
+	}
+}
+
+void CSessionRecorder::RecordConnect(EntityId playerId, int channelId)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Connect, playerId))
+	{
+		pRecord->values[0] = static_cast<float>(channelId);
+	}
+}
+
+void CSessionRecorder::RecordDisconnect(EntityId playerId, int channelId)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Disconnect, playerId))
+	{
+		pRecord->values[0] = static_cast<float>(channelId);
+	}
+}
+
+void CSessionRecorder::RecordSpawn(EntityId playerId, const Vec3& position)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Spawn, playerId))
+	{
+		pRecord->values[0] = position.x;
+		pRecord->values[1] = position.y;
+		pRecord->values[2] = position.z;
+	}
+}
+
+void CSessionRecorder::RecordInput(EntityId playerId, const PlayerInput::SFrame& input)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Input, playerId))
+	{
+		const Vec2 lookDelta = input.GetLookDelta();
+		pRecord->inputFlags = input.flags;
+		pRecord->events = input.events;
+		pRecord->values[0] = lookDelta.x;
+		pRecord->values[1] = lookDelta.y;
+	}
+}
+
+void CSessionRecorder::RecordProjectile(EntityId shooterId, const Vec3& position, const Vec3& velocity)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Projectile, shooterId))
+	{
+		pRecord->values[0] = position.x;
+		pRecord->values[1] = position.y;
+		pRecord->values[2] = position.z;
+		pRecord->values[3] = velocity.x;
+		pRecord->values[4] = velocity.y;
+		pRecord->values[5] = velocity.z;
+	}
+}
+
+void CSessionRecorder::RecordCollision(EntityId entityId, const Vec3& point, float mass)
+{
+	if (SessionRecording::SRecord* pRecord = Append(SessionRecording::ERecord::Collision, entityId))
+	{
+		pRecord->values[0] = point.x;
+		pRecord->values[1] = point.y;
+		pRecord->values[2] = point.z;
+		pRecord->values[3] = mass;
+	}
+}
+
+void CSessionRecorder::LogStatistics() const
+{
+	CryLogAlways("Session recorder: %s, %u frames, %" PRIu64 " records, %.1f KB written",
+		m_pFile != nullptr ? "recording" : "stopped", m_statistics.frames, m_statistics.records, m_statistics.bytesWritten / 1024.f);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "SessionRecordingFormat.h"
+#include "../Components/PlayerInputRing.h"
+
+////////////////////////////////////////////////////////
+// Records what drives the simulation of a session: frame times, connections, spawns, player input frames,
+// projectiles and collisions, written while g_sessionRecord is set
+// Recording starts with the first client connection and ends on level unload, see SessionRecordingFormat.h for the file
+// g_sessionReplay plays a recording back through the game, see CSessionReplay
+// Records are written from the main thread only
+////////////////////////////////////////////////////////
+class CSessionRecorder
+{
+public:
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		uint64 records = 0;
+		uint64 bytesWritten = 0;
+	};
+
+public:
+	static constexpr const char* DefaultPath = "%USER%/GameSession.rec";
+	// Records buffered in memory before they are appended to the file, about a second of a busy session
+	static const uint32 BufferCapacity = 4096;
+
+public:
+	~CSessionRecorder() { Stop(); }
+
+	// Creates the file and writes the header, records are discarded while stopped
+	bool Start(const char* szPath);
+	void Stop();
+	bool IsRecording() const { return m_pFile != nullptr; }
+
+	// Cheap while not recording
+	static void RecordFrame(float frameTime);
+	static void RecordConnect(EntityId playerId, int channelId);
+	static void RecordDisconnect(EntityId playerId, int channelId);
+	static void RecordSpawn(EntityId playerId, const Vec3& position);
+	static void RecordInput(EntityId playerId, const PlayerInput::SFrame& input);
+	static void RecordProjectile(EntityId shooterId, const Vec3& position, const Vec3& velocity);
+	static void RecordCollision(EntityId entityId, const Vec3& point, float mass);
+
+	void LogStatistics() const;
+
+protected:
+	// Next record in the buffer, nullptr while not recording
+	static SessionRecording::SRecord* Append(SessionRecording::ERecord type, EntityId entityId);
+	void Flush();
+
+protected:
+	static CSessionRecorder* s_pActive;
+
+	FILE* m_pFile = nullptr;
+	std::vector<SessionRecording::SRecord> m_buffer;
+
+	SStatistics m_statistics;
+};
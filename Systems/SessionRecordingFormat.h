@@ -0,0 +1,74 @@
+#pragma once
+
+// File layout of session recordings, keep free of engine headers
+#include <cstdint>
+
+// A recording is a SFileHeader followed by SRecord entries in the order they happened, nothing is ever rewritten
+// Records are fixed size and naturally aligned, a mapped file can be read as an array of records in place
+namespace SessionRecording
+{
+	// Append only, replays rely on the numbering of existing records
+	enum class ERecord : uint8_t
+	{
+		// Starts a frame, values[0] frame time, the records up to the next frame happened during it
+		Frame = 0,
+		// Client connected, entityId is its player, values[0] the channel id
+		Connect,
+		// Client disconnected, entityId is its player, values[0] the channel id
+		Disconnect,
+		// Player revived, values[0..2] position, looking along the spawn point
+		Spawn,
+		// Input frame committed for a player, inputFlags, events and values[0..1] the quantized look delta
+		// A player has one per fixed step, the n-th input of a player within a frame belongs to the n-th step of the frame
+		Input,
+		// Projectile launched, entityId is the shooter, values[0..2] position and values[3..5] velocity
+		Projectile,
+		// Projectile hit, entityId is the entity hit, values[0..2] point and values[3] projectile mass
+		Collision,
+		Count
+	};
+
+	static const uint32_t MaxValues = 6;
+
+	struct SRecord
+	{
+		uint8_t type;
+		// PlayerSimulation::EInputFlag bits of Input records
+		uint8_t inputFlags;
+		// PlayerInput::EEvent bits of Input records
+		uint8_t events;
+		uint8_t reserved;
+		uint32_t entityId;
+		float values[MaxValues];
+	};
+	static_assert(sizeof(SRecord) == 32, "Session records are expected to be 32 bytes");
+
+	static const uint32_t FileMagic = 0x53455347; // "GSES"
+	// Bumped whenever the header or a record changes meaning, 2 added the step rate and 3 the mouse filter
+	static const uint32_t FileVersion = 3;
+
+	struct SFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t recordSize;
+		uint32_t reserved;
+
+		// Settings the session was recorded with, replays simulate with these instead of the current ones
+		float walkSpeed;
+		float crouchSpeed;
+		float rotationSpeed;
+		float minPitch;
+		float maxPitch;
+		float projectileMaxAge;
+		// Fixed player steps per second and the most steps per frame, a rate of 0 steps once per frame, see CSimulationClock
+		int32_t tickRate;
+		int32_t maxTicksPerFrame;
+		// Mouse filter as a PlayerInput::EFilter and its parameters, see g_mouseFilter
+		int32_t mouseFilter;
+		float mouseFilterTimeConstant;
+		float mouseFilterMinCutoff;
+		float mouseFilterBeta;
+	};
+	static_assert(sizeof(SFileHeader) % sizeof(SRecord) == 0, "Records are expected to stay aligned to their size");
+}
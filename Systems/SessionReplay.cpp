@@ -0,0 +1,364 @@
+#include "StdAfx.h"
+#include "SessionReplay.h"
+
+#include "../GamePlugin.h"
+#include "../Components/Player.h"
+
+#include <CrySystem/File/ICryPak.h>
+#include <CrySystem/IConsole.h>
+#include <ILevelSystem.h>
+
+#include <algorithm>
+
+CSessionReplay* CSessionReplay::s_pActive = nullptr;
+
+bool CSessionReplay::Start(const char* szPath, bool bRender)
+{
+	using namespace SessionRecording;
+
+	if (s_pActive != nullptr)
+	{
+		CryLogAlways("Session replay: already replaying %s", s_pActive->m_path.c_str());
+		return false;
+	}
+
+	CGamePlugin* pPlugin = CGamePlugin::GetInstance();
+	if (pPlugin == nullptr || gEnv->IsEditor() || gEnv->pGameFramework->GetILevelSystem()->GetCurrentLevel() == nullptr)
+	{
+		CryLogAlways("Session replay: load a level first");
+		return false;
+	}
+	if (pPlugin->GetSessionRecorder().IsRecording())
+	{
+		CryLogAlways("Session replay: stop recording first (g_sessionRecord 0)");
+		return false;
+	}
+
+	// Same location the recorder writes to
+	char szAdjustedPath[_MAX_PATH];
+	gEnv->pCryPak->AdjustFileName(szPath, szAdjustedPath, ICryPak::FLAGS_FOR_WRITING);
+
+	FILE* pFile = fopen(szAdjustedPath, "rb");
+	if (pFile == nullptr)
+	{
+		CryLogAlways("Session replay: could not open %s", szAdjustedPath);
+		return false;
+	}
+
+	SFileHeader header;
+	if (fread(&header, sizeof(header), 1, pFile) != 1 || header.magic != FileMagic || header.version != FileVersion || header.recordSize != sizeof(SRecord))
+	{
+		CryLogAlways("Session replay: %s is not a session recording of version %u", szAdjustedPath, FileVersion);
+		fclose(pFile);
+		return false;
+	}
+
+	// Read in one go, input records are handed to the players in place
+	fseek(pFile, 0, SEEK_END);
+	const long fileSize = ftell(pFile);
+	fseek(pFile, sizeof(header), SEEK_SET);
+
+	m_records.resize(static_cast<size_t>(max(fileSize - (long)sizeof(header), 0L)) / sizeof(SRecord));
+	m_records.resize(fread(m_records.data(), sizeof(SRecord), m_records.size(), pFile));
+	fclose(pFile);
+
+	m_path = szAdjustedPath;
+	m_nextRecord = 0;
+	m_statistics = SStatistics();
+
+	// Simulate with the settings of the recorded session
+	OverrideCVar("g_WalkingSpeed", header.walkSpeed);
+	OverrideCVar("g_crouchSpeed", header.crouchSpeed);
+	OverrideCVar("g_rotationSpeed", header.rotationSpeed);
+	// The pitch limits clamp against each other, the one making room goes first and Stop restores in reverse order
+	if (header.minPitch > CUserSettings::Get().maxPitch)
+	{
+		OverrideCVar("g_pitchMax", header.maxPitch);
+		OverrideCVar("g_pitchMin", header.minPitch);
+	}
+	else
+	{
+		OverrideCVar("g_pitchMin", header.minPitch);
+		OverrideCVar("g_pitchMax", header.maxPitch);
+	}
+	OverrideCVar("g_projectileMaxAge", header.projectileMaxAge);
+	OverrideCVar("g_playerTickRate", header.tickRate);
+	OverrideCVar("g_playerMaxTicksPerFrame", header.maxTicksPerFrame);
+	OverrideCVar("g_mouseFilter", header.mouseFilter);
+	OverrideCVar("g_mouseFilterTimeConstant", header.mouseFilterTimeConstant);
+	OverrideCVar("g_mouseFilterMinCutoff", header.mouseFilterMinCutoff);
+	OverrideCVar("g_mouseFilterBeta", header.mouseFilterBeta);
+	// Replayed players are moved by their recorded input on this machine, not by commands of a client
+	OverrideCVar("g_netPrediction", 0);
+	if (!bRender)
+	{
+		OverrideCVar("e_Render", 0);
+	}
+
+	s_pActive = this;
+	SetNextFrameTime();
+
+#if defined(GAME_PROFILER)
+	// Only the replayed frames show up in the marker statistics logged by Stop
+	CProfiler::ResetStatistics();
+#endif
+
+	CryLogAlways("Session replay: replaying %s, %" PRISIZE_T " records, %s", szAdjustedPath, m_records.size(), bRender ? "rendered" : "without rendering");
+	m_startTicks = CryGetTicks();
+	return true;
+}
+
+void CSessionReplay::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	const int64 totalTicks = CryGetTicks() - m_startTicks;
+	const bool bComplete = m_nextRecord >= m_records.size();
+	s_pActive = nullptr;
+
+	for (const SPlayer& player : m_players)
+	{
+		gEnv->pEntitySystem->RemoveEntity(player.entityId);
+	}
+	m_players.clear();
+
+	for (auto it = m_savedCVars.rbegin(); it != m_savedCVars.rend(); ++it)
+	{
+		if (ICVar* pCVar = gEnv->pConsole->GetCVar(it->first.c_str()))
+		{
+			pCVar->Set(it->second.c_str());
+		}
+	}
+	m_savedCVars.clear();
+
+	m_records.clear();
+	m_records.shrink_to_fit();
+
+	using SessionRecording::ERecord;
+	const double wallSeconds = totalTicks / (double)CryGetTicksPerSec();
+	CryLogAlways("Session replay: %s%s, %u frames, %.1f s recorded, replayed in %.2f s, %.2fx real time, up to %u players",
+		m_path.c_str(), bComplete ? "" : " (stopped early)", m_statistics.frames, m_statistics.recordedSeconds, wallSeconds,
+		wallSeconds > 0.0 ? m_statistics.recordedSeconds / wallSeconds : 0.0, m_statistics.maxPlayers);
+	CryLogAlways("    %u input frames injected, %u left over by players stepping less often than recorded",
+		m_statistics.injectedInputs, m_statistics.droppedInputs);
+	CryLogAlways("    recorded %u connections, %u disconnections, %u spawns, %u input frames, %u projectiles, %u collisions, %u unknown records",
+		m_statistics.records[(size_t)ERecord::Connect], m_statistics.records[(size_t)ERecord::Disconnect], m_statistics.records[(size_t)ERecord::Spawn],
+		m_statistics.records[(size_t)ERecord::Input], m_statistics.records[(size_t)ERecord::Projectile], m_statistics.records[(size_t)ERecord::Collision],
+		m_statistics.unknownRecords);
+
+#if defined(GAME_PROFILER)
+	CProfiler::LogStatistics(nullptr);
+#else
+	CryLogAlways("    gameplay profiling markers are compiled out of release builds");
+#endif
+}
+
+float CSessionReplay::BeginFrame(float frameTime)
+{
+	using namespace SessionRecording;
+
+	if (!IsRunning())
+		return frameTime;
+
+	if (m_nextRecord >= m_records.size())
+	{
+		Stop();
+		return frameTime;
+	}
+
+	// An input a player didn't step through would shift all of its later inputs by a step
+	for (SPlayer& player : m_players)
+	{
+		m_statistics.droppedInputs += static_cast<uint32>(player.inputs.size());
+		player.inputs.clear();
+	}
+
+	// Records before the first frame record, e.g. the connection that started the recording, run with the first update
+	float recordedFrameTime = 0.f;
+	if (m_records[m_nextRecord].type == (uint8_t)ERecord::Frame)
+	{
+		recordedFrameTime = m_records[m_nextRecord].values[0];
+		m_statistics.recordedSeconds += recordedFrameTime;
+		++m_statistics.frames;
+		++m_statistics.records[(size_t)ERecord::Frame];
+		++m_nextRecord;
+	}
+
+	for (const size_t count = m_records.size(); m_nextRecord < count && m_records[m_nextRecord].type != (uint8_t)ERecord::Frame; ++m_nextRecord)
+	{
+		const SRecord& record = m_records[m_nextRecord];
+		if (record.type >= (uint8_t)ERecord::Count)
+		{
+			++m_statistics.unknownRecords;
+			continue;
+		}
+		++m_statistics.records[record.type];
+
+		switch ((ERecord)record.type)
+		{
+		case ERecord::Connect:
+			GetPlayer(record.entityId);
+			break;
+		case ERecord::Spawn:
+		{
+			// Revived where the recorded player was, whatever the spawn policy picks now
+			SPlayer* pPlayer = GetPlayer(record.entityId);
+			IEntity* pEntity = pPlayer != nullptr ? gEnv->pEntitySystem->GetEntity(pPlayer->entityId) : nullptr;
+			if (pEntity != nullptr)
+			{
+				if (CPlayerComponent* pPlayerComponent = pEntity->GetComponent<CPlayerComponent>())
+				{
+					pPlayerComponent->Revive();
+				}
+				pEntity->SetPos(Vec3(record.values[0], record.values[1], record.values[2]));
+			}
+		}
+		break;
+		case ERecord::Input:
+			if (SPlayer* pPlayer = GetPlayer(record.entityId))
+			{
+				pPlayer->inputs.push_back(&record);
+			}
+			break;
+		case ERecord::Disconnect:
+			RemovePlayer(record.entityId);
+			break;
+		// Shots, throws and impacts happen again from the replayed input and physics, the recorded ones are only counted
+		default:
+			break;
+		}
+	}
+
+	SetNextFrameTime();
+	return recordedFrameTime;
+}
+
+bool CSessionReplay::ApplyInput(EntityId playerId, PlayerInput::CRing& ring)
+{
+	SPlayer* pPlayer = s_pActive != nullptr ? s_pActive->FindPlayer(playerId) : nullptr;
+	if (pPlayer == nullptr)
+		return false;
+
+	// Replayed players only ever see recorded input, a step without a recorded input frame has no input
+	ring.Clear();
+	if (!pPlayer->inputs.empty())
+	{
+		const SessionRecording::SRecord& record = *pPlayer->inputs.front();
+		pPlayer->inputs.pop_front();
+
+		// The camera of a replayed player is never the view, switching it would only add work the recorded session didn't do
+		ring.SetFlags(record.inputFlags);
+		ring.AddLookDelta(Vec2(record.values[0], record.values[1]));
+		ring.AddEvents(record.events & ~(uint8)PlayerInput::EEvent::CameraSwitch);
+		++s_pActive->m_statistics.injectedInputs;
+	}
+
+	return true;
+}
+
+CSessionReplay::SPlayer* CSessionReplay::GetPlayer(EntityId recordedId)
+{
+	for (SPlayer& player : m_players)
+	{
+		if (player.recordedId == recordedId)
+			return &player;
+	}
+
+	// Neither local nor bound to the network, the view and the local input stay with the local player
+	SEntitySpawnParams spawnParams;
+	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+	spawnParams.sName = "ReplayPlayer";
+	spawnParams.nFlags |= ENTITY_FLAG_NEVER_NETWORK_STATIC;
+
+	IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams);
+	if (pEntity == nullptr)
+		return nullptr;
+
+	pEntity->GetOrCreateComponentClass<CPlayerComponent>();
+
+	m_players.emplace_back();
+	m_players.back().recordedId = recordedId;
+	m_players.back().entityId = pEntity->GetId();
+	m_statistics.maxPlayers = max(m_statistics.maxPlayers, static_cast<uint32>(m_players.size()));
+	return &m_players.back();
+}
+
+CSessionReplay::SPlayer* CSessionReplay::FindPlayer(EntityId entityId)
+{
+	for (SPlayer& player : m_players)
+	{
+		if (player.entityId == entityId)
+			return &player;
+	}
+	return nullptr;
+}
+
+void CSessionReplay::RemovePlayer(EntityId recordedId)
+{
+	for (auto it = m_players.begin(); it != m_players.end(); ++it)
+	{
+		if (it->recordedId == recordedId)
+		{
+			gEnv->pEntitySystem->RemoveEntity(it->entityId);
+			m_statistics.droppedInputs += static_cast<uint32>(it->inputs.size());
+			m_players.erase(it);
+			return;
+		}
+	}
+}
+
+ICVar* CSessionReplay::SaveCVar(const char* szName)
+{
+	ICVar* pCVar = gEnv->pConsole->GetCVar(szName);
+	if (pCVar == nullptr)
+		return nullptr;
+
+	const bool bSaved = std::find_if(m_savedCVars.begin(), m_savedCVars.end(),
+		[szName](const std::pair<string, string>& saved) { return saved.first == szName; }) != m_savedCVars.end();
+	if (!bSaved)
+	{
+		m_savedCVars.emplace_back(string(szName), string(pCVar->GetString()));
+	}
+	return pCVar;
+}
+
+void CSessionReplay::OverrideCVar(const char* szName, float value)
+{
+	if (ICVar* pCVar = SaveCVar(szName))
+	{
+		pCVar->Set(value);
+	}
+}
+
+void CSessionReplay::OverrideCVar(const char* szName, int value)
+{
+	if (ICVar* pCVar = SaveCVar(szName))
+	{
+		pCVar->Set(value);
+	}
+}
+
+void CSessionReplay::SetNextFrameTime()
+{
+	for (size_t i = m_nextRecord, count = m_records.size(); i < count; ++i)
+	{
+		if (m_records[i].type == (uint8_t)SessionRecording::ERecord::Frame)
+		{
+			// Fixed engine frame time, the renderer and the frame rate limit no longer stretch or shrink the frame
+			OverrideCVar("t_FixedStep", m_records[i].values[0]);
+			return;
+		}
+	}
+}
+
+void CSessionReplay::Replay(IConsoleCmdArgs* pArgs)
+{
+	const char* szPath = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : CSessionRecorder::DefaultPath;
+	const bool bRender = pArgs->GetArgCount() > 2 ? atoi(pArgs->GetArg(2)) != 0 : true;
+
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetSessionReplay().Start(szPath, bRender);
+	}
+}
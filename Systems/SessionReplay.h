@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "SessionRecordingFormat.h"
+#include "../Components/PlayerInputRing.h"
+
+struct IConsoleCmdArgs;
+struct ICVar;
+
+////////////////////////////////////////////////////////
+// Plays a session recording back through the running game, see g_sessionReplay
+// Recorded players are spawned as player entities, their recorded input frames are injected into their input rings and
+// every frame runs with its recorded frame time, so entities, physics, animation and the gameplay profiling markers
+// cost what they cost in the recorded session and two builds can be compared on the exact same workload
+// Rendering can be turned off to measure the game update alone, frames then run as fast as the game updates
+// The recorded settings replace the current ones for the duration of the replay
+////////////////////////////////////////////////////////
+class CSessionReplay
+{
+public:
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		float recordedSeconds = 0.f;
+		uint32 records[(size_t)SessionRecording::ERecord::Count] = {};
+		uint32 unknownRecords = 0;
+		// Input frames handed to replayed players, and the ones left over because their player didn't step as often as recorded
+		uint32 injectedInputs = 0;
+		uint32 droppedInputs = 0;
+		uint32 maxPlayers = 0;
+	};
+
+public:
+	// Loads the recording, applies its settings and spawns its players from the next frame on
+	bool Start(const char* szPath, bool bRender);
+	// Restores the settings, removes the replayed players and logs the results
+	void Stop();
+	bool IsRunning() const { return s_pActive == this; }
+
+	// Applies the records of the next recorded frame and returns its frame time, frameTime while not replaying
+	float BeginFrame(float frameTime);
+
+	// Replaces the input frame being assembled with the next recorded input of a replayed player, false for other players
+	static bool ApplyInput(EntityId playerId, PlayerInput::CRing& ring);
+
+	// Usage: g_sessionReplay [file = %USER%/GameSession.rec] [render = 1]
+	static void Replay(IConsoleCmdArgs* pArgs);
+
+protected:
+	struct SPlayer
+	{
+		EntityId recordedId = INVALID_ENTITYID;
+		EntityId entityId = INVALID_ENTITYID;
+		// Input records of the current frame, one per fixed step
+		std::deque<const SessionRecording::SRecord*> inputs;
+	};
+
+	// Replayed player of a recorded one, spawned on its first record
+	SPlayer* GetPlayer(EntityId recordedId);
+	SPlayer* FindPlayer(EntityId entityId);
+	void RemovePlayer(EntityId recordedId);
+
+	// Sets a console variable for the duration of the replay, the first value seen is restored by Stop
+	void OverrideCVar(const char* szName, float value);
+	void OverrideCVar(const char* szName, int value);
+	// nullptr if the variable doesn't exist in this build
+	ICVar* SaveCVar(const char* szName);
+	// Frame time of the next frame record, so that the engine timer and physics advance like the recorded frame
+	void SetNextFrameTime();
+
+protected:
+	static CSessionReplay* s_pActive;
+
+	string m_path;
+	std::vector<SessionRecording::SRecord> m_records;
+	size_t m_nextRecord = 0;
+
+	std::vector<SPlayer> m_players;
+	// Name and value before the replay, restored in reverse order
+	std::vector<std::pair<string, string>> m_savedCVars;
+
+	int64 m_startTicks = 0;
+	SStatistics m_statistics;
+};
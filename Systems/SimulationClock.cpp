@@ -0,0 +1,67 @@
+#include "StdAfx.h"
+#include "SimulationClock.h"
+
+#include <CrySystem/IConsole.h>
+
+int CSimulationClock::s_tickRate = 60;
+int CSimulationClock::s_maxStepsPerFrame = 4;
+CSimulationClock::SStatistics CSimulationClock::s_statistics;
+
+void CSimulationClock::RegisterCVars()
+{
+	ConsoleRegistrationHelper::Register("g_playerTickRate", &s_tickRate, 60, VF_RESTRICTEDMODE, "Fixed steps per second of player movement, look and state machine, rendering interpolates in between\n"
+		"0 = One step per rendered frame with the frame time");
+	ConsoleRegistrationHelper::Register("g_playerMaxTicksPerFrame", &s_maxStepsPerFrame, 4, VF_RESTRICTEDMODE, "Most fixed player steps simulated in one rendered frame, simulation time beyond that is dropped after hitches");
+}
+
+void CSimulationClock::UnregisterCVars()
+{
+	gEnv->pConsole->UnregisterVariable("g_playerTickRate", true);
+	gEnv->pConsole->UnregisterVariable("g_playerMaxTicksPerFrame", true);
+}
+
+uint32 CSimulationClock::Advance(float frameTime, int tickRate, int maxStepsPerFrame)
+{
+	if (frameTime <= 0.f)
+		return 0;
+
+	++s_statistics.frames;
+
+	if (tickRate <= 0)
+	{
+		m_stepTime = frameTime;
+		m_accumulator = 0.f;
+		m_alpha = 1.f;
+		++s_statistics.steps;
+		return 1;
+	}
+
+	m_stepTime = 1.f / tickRate;
+	m_accumulator += frameTime;
+
+	uint32 steps = static_cast<uint32>(m_accumulator / m_stepTime);
+	const uint32 maxSteps = static_cast<uint32>(max(maxStepsPerFrame, 1));
+	if (steps > maxSteps)
+	{
+		const float droppedTime = (steps - maxSteps) * m_stepTime;
+		m_accumulator -= droppedTime;
+		s_statistics.droppedTime += droppedTime;
+		++s_statistics.cappedFrames;
+		steps = maxSteps;
+	}
+
+	m_accumulator = max(m_accumulator - steps * m_stepTime, 0.f);
+	m_alpha = min(m_accumulator / m_stepTime, 1.f);
+
+	s_statistics.steps += steps;
+	return steps;
+}
+
+void CSimulationClock::LogStatistics(IConsoleCmdArgs* pArgs)
+{
+	const float frames = (float)max(s_statistics.frames, 1u);
+	CryLogAlways("Player simulation clock: %d steps per second (%s), %.2f steps per frame, %u frames capped at %d steps, %.3f s dropped",
+		s_tickRate, s_tickRate > 0 ? "fixed" : "per frame", s_statistics.steps / frames, s_statistics.cappedFrames, s_maxStepsPerFrame, s_statistics.droppedTime);
+
+	s_statistics = SStatistics();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+struct IConsoleCmdArgs;
+
+////////////////////////////////////////////////////////
+// Fixed-timestep clock for player simulation
+// Rendered frames add their time to an accumulator and the simulation runs as many fixed steps as fit, so movement,
+// look and the state machine advance the same way and cost the same per second at any frame rate
+// Steps per frame are capped, time that can't be caught up after a hitch is dropped instead of spiralling
+// Rendering shows the state between the last two steps, GetAlpha says where
+////////////////////////////////////////////////////////
+class CSimulationClock
+{
+public:
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		uint32 steps = 0;
+		// Frames that hit the step cap and the simulation time dropped by them
+		uint32 cappedFrames = 0;
+		float droppedTime = 0.f;
+	};
+
+public:
+	// Bound to g_playerTickRate and g_playerMaxTicksPerFrame
+	static void RegisterCVars();
+	static void UnregisterCVars();
+
+	// Adds the time of a rendered frame, returns the number of fixed steps to simulate now
+	uint32 Advance(float frameTime) { return Advance(frameTime, s_tickRate, s_maxStepsPerFrame); }
+	// Same with an explicit rate, a rate of 0 simulates one step per frame with the frame time
+	uint32 Advance(float frameTime, int tickRate, int maxStepsPerFrame);
+
+	// Duration of the steps returned by the last Advance
+	float GetStepTime() const { return m_stepTime; }
+	// Render position between the second to last step (0) and the last step (1)
+	float GetAlpha() const { return m_alpha; }
+
+	void Reset() { m_accumulator = 0.f; m_alpha = 1.f; }
+
+	// Steps per frame and dropped time of all clocks since the last call
+	static void LogStatistics(IConsoleCmdArgs* pArgs);
+
+protected:
+	float m_accumulator = 0.f;
+	float m_stepTime = 0.f;
+	float m_alpha = 1.f;
+
+	static int s_tickRate;
+	static int s_maxStepsPerFrame;
+	static SStatistics s_statistics;
+};
@@ -0,0 +1,209 @@
+#include "StdAfx.h"
+#include "SpawnRegistry.h"
+
+#include "../Components/SpawnPoint.h"
+
+#include <CrySystem/IConsole.h>
+
+void CPointGrid::Build(const std::vector<Vec3>& points)
+{
+	m_points = points;
+	m_cells.clear();
+
+	m_minCell[0] = m_minCell[1] = INT_MAX;
+	m_maxCell[0] = m_maxCell[1] = INT_MIN;
+
+	for (uint32 i = 0; i < m_points.size(); ++i)
+	{
+		const int x = GetCellCoordinate(m_points[i].x);
+		const int y = GetCellCoordinate(m_points[i].y);
+		m_cells[GetCellKey(x, y)].push_back(i);
+
+		m_minCell[0] = min(m_minCell[0], x);
+		m_minCell[1] = min(m_minCell[1], y);
+		m_maxCell[0] = max(m_maxCell[0], x);
+		m_maxCell[1] = max(m_maxCell[1], y);
+	}
+}
+
+float CPointGrid::GetNearestDistanceSq(const Vec3& pos, float stopDistanceSq) const
+{
+	if (m_points.empty())
+		return FLT_MAX;
+
+	const int centerX = GetCellCoordinate(pos.x);
+	const int centerY = GetCellCoordinate(pos.y);
+
+	// Ring that reaches the farthest occupied cell
+	const int lastRing = max(max(abs(centerX - m_minCell[0]), abs(m_maxCell[0] - centerX)), max(abs(centerY - m_minCell[1]), abs(m_maxCell[1] - centerY)));
+
+	float nearestDistanceSq = FLT_MAX;
+
+	// Only called for cells within the occupied bounds
+	auto visitCell = [&](int x, int y)
+	{
+		++m_visitedCells;
+		auto it = m_cells.find(GetCellKey(x, y));
+		if (it == m_cells.end())
+			return;
+
+		for (uint32 pointIndex : it->second)
+		{
+			nearestDistanceSq = min(nearestDistanceSq, (m_points[pointIndex] - pos).GetLengthSquared());
+		}
+	};
+
+	for (int ring = 0; ring <= lastRing; ++ring)
+	{
+		// Points in this ring and beyond are at least (ring - 1) cells away horizontally
+		const float ringDistance = max(ring - 1, 0) * m_cellSize;
+		if (nearestDistanceSq <= ringDistance * ringDistance)
+			break;
+
+		if (ring == 0)
+		{
+			if (centerX >= m_minCell[0] && centerX <= m_maxCell[0] && centerY >= m_minCell[1] && centerY <= m_maxCell[1])
+				visitCell(centerX, centerY);
+		}
+		else
+		{
+			// Sides of the ring clipped to the occupied bounds, a query far outside them only walks the part facing them
+			const int minX = max(centerX - ring, m_minCell[0]);
+			const int maxX = min(centerX + ring, m_maxCell[0]);
+			const int minY = max(centerY - ring + 1, m_minCell[1]);
+			const int maxY = min(centerY + ring - 1, m_maxCell[1]);
+
+			for (int y : { centerY - ring, centerY + ring })
+			{
+				if (y < m_minCell[1] || y > m_maxCell[1])
+					continue;
+				for (int x = minX; x <= maxX; ++x)
+				{
+					visitCell(x, y);
+				}
+			}
+			for (int x : { centerX - ring, centerX + ring })
+			{
+				if (x < m_minCell[0] || x > m_maxCell[0])
+					continue;
+				for (int y = minY; y <= maxY; ++y)
+				{
+					visitCell(x, y);
+				}
+			}
+		}
+
+		if (nearestDistanceSq < stopDistanceSq)
+			break;
+	}
+
+	return nearestDistanceSq;
+}
+
+void CSpawnRegistry::Register(CSpawnPointComponent& spawnPoint)
+{
+	if (m_indices.find(&spawnPoint) != m_indices.end())
+		return;
+
+	// Spawn points that were never used come up in registration order
+	m_indices[&spawnPoint] = static_cast<uint32>(m_entries.size());
+	m_entries.push_back({ &spawnPoint, ++m_useCounter });
+	m_byLastUse.emplace(m_entries.back().lastUse, &spawnPoint);
+}
+
+void CSpawnRegistry::Unregister(CSpawnPointComponent& spawnPoint)
+{
+	auto it = m_indices.find(&spawnPoint);
+	if (it == m_indices.end())
+		return;
+
+	const uint32 index = it->second;
+	m_byLastUse.erase(std::make_pair(m_entries[index].lastUse, static_cast<const CSpawnPointComponent*>(&spawnPoint)));
+	m_indices.erase(it);
+
+	// Unregistering only happens when spawn points are removed, keeping the order is worth the shift
+	m_entries.erase(m_entries.begin() + index);
+	for (uint32 i = index; i < m_entries.size(); ++i)
+	{
+		m_indices[m_entries[i].pSpawnPoint] = i;
+	}
+}
+
+CSpawnPointComponent* CSpawnRegistry::Select(const std::vector<Vec3>& otherPlayerPositions)
+{
+	ESelectionPolicy policy = ESelectionPolicy::FarthestFromPlayers;
+	if (ICVar* pPolicy = gEnv->pConsole->GetCVar("g_spawnPolicy"))
+	{
+		policy = static_cast<ESelectionPolicy>(CLAMP(pPolicy->GetIVal(), 0, (int)ESelectionPolicy::Last - 1));
+	}
+
+	return Select(policy, otherPlayerPositions);
+}
+
+CSpawnPointComponent* CSpawnRegistry::Select(ESelectionPolicy policy, const std::vector<Vec3>& otherPlayerPositions)
+{
+	if (m_entries.empty())
+		return nullptr;
+
+	++m_statistics.selections;
+
+	switch (policy)
+	{
+	case ESelectionPolicy::First:
+		return Use(0);
+	case ESelectionPolicy::RoundRobin:
+		return Use(m_roundRobinCursor++ % GetCount());
+	case ESelectionPolicy::FarthestFromPlayers:
+		if (!otherPlayerPositions.empty())
+			return SelectFarthest(otherPlayerPositions);
+		// Without other players every spawn point is equally far away
+		[[fallthrough]];
+	case ESelectionPolicy::LeastRecentlyUsed:
+	default:
+		return Use(m_indices[m_byLastUse.begin()->second]);
+	}
+}
+
+CSpawnPointComponent* CSpawnRegistry::SelectFarthest(const std::vector<Vec3>& otherPlayerPositions)
+{
+	m_playerGrid.Build(otherPlayerPositions);
+
+	uint32 bestIndex = 0;
+	float bestDistanceSq = -1.f;
+
+	for (uint32 i = 0; i < m_entries.size(); ++i)
+	{
+		// A spawn point with a player closer than the current best can't win, stop its search there
+		const Vec3 spawnPos = m_entries[i].pSpawnPoint->GetEntity()->GetWorldPos();
+		const float distanceSq = m_playerGrid.GetNearestDistanceSq(spawnPos, bestDistanceSq);
+
+		// Ties go to the spawn point that was used longer ago
+		if (distanceSq > bestDistanceSq || (distanceSq == bestDistanceSq && m_entries[i].lastUse < m_entries[bestIndex].lastUse))
+		{
+			bestDistanceSq = distanceSq;
+			bestIndex = i;
+		}
+	}
+
+	m_statistics.visitedCells += m_playerGrid.ConsumeVisitedCells();
+	return Use(bestIndex);
+}
+
+CSpawnPointComponent* CSpawnRegistry::Use(uint32 index)
+{
+	SEntry& entry = m_entries[index];
+
+	m_byLastUse.erase(std::make_pair(entry.lastUse, static_cast<const CSpawnPointComponent*>(entry.pSpawnPoint)));
+	entry.lastUse = ++m_useCounter;
+	m_byLastUse.emplace(entry.lastUse, entry.pSpawnPoint);
+
+	return entry.pSpawnPoint;
+}
+
+void CSpawnRegistry::LogStatistics()
+{
+	CryLogAlways("Spawn registry: %u spawn points, %u selections, %.1f grid cells searched per selection", GetCount(), m_statistics.selections,
+		m_statistics.selections > 0 ? (float)m_statistics.visitedCells / m_statistics.selections : 0.f);
+
+	m_statistics = SStatistics();
+}
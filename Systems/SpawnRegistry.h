@@ -0,0 +1,103 @@
+#pragma once
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class CSpawnPointComponent;
+
+////////////////////////////////////////////////////////
+// Uniform 2D grid over a set of points, answers nearest point queries by searching rings of cells around the query
+////////////////////////////////////////////////////////
+class CPointGrid
+{
+public:
+	explicit CPointGrid(float cellSize = 16.f) : m_cellSize(cellSize) {}
+
+	void Build(const std::vector<Vec3>& points);
+
+	// Squared distance to the nearest point, FLT_MAX without points
+	// Stops early once a point closer than sqrt(stopDistanceSq) is found, the result is then only an upper bound
+	float GetNearestDistanceSq(const Vec3& pos, float stopDistanceSq = 0.f) const;
+
+	// Cells looked at by all queries since the last call
+	uint32 ConsumeVisitedCells() { const uint32 visited = m_visitedCells; m_visitedCells = 0; return visited; }
+
+protected:
+	static uint64 GetCellKey(int x, int y) { return (uint64(uint32(x)) << 32) | uint32(y); }
+	int GetCellCoordinate(float value) const { return static_cast<int>(floor(value / m_cellSize)); }
+
+protected:
+	float m_cellSize;
+	std::vector<Vec3> m_points;
+	// Indices into m_points per occupied cell
+	std::unordered_map<uint64, std::vector<uint32>> m_cells;
+	// Bounds of the occupied cells, the ring search stops once it covers them
+	int m_minCell[2] = { 0, 0 };
+	int m_maxCell[2] = { -1, -1 };
+	mutable uint32 m_visitedCells = 0;
+};
+
+////////////////////////////////////////////////////////
+// Spawn points of the current level, registered by CSpawnPointComponent itself
+// Replaces walking the entity system for a spawner on every revive
+////////////////////////////////////////////////////////
+class CSpawnRegistry
+{
+public:
+	// How the spawn point for a revive is picked, see g_spawnPolicy
+	enum class ESelectionPolicy
+	{
+		// First registered spawn point, what revives have always used
+		First = 0,
+		RoundRobin,
+		LeastRecentlyUsed,
+		// Spawn point with the largest distance to the nearest other player, least recently used without other players
+		FarthestFromPlayers,
+		Last
+	};
+
+	struct SStatistics
+	{
+		uint32 selections = 0;
+		// Grid cells searched by farthest-from-players selections
+		uint32 visitedCells = 0;
+	};
+
+public:
+	void Register(CSpawnPointComponent& spawnPoint);
+	void Unregister(CSpawnPointComponent& spawnPoint);
+
+	// Picks a spawn point with the policy configured in g_spawnPolicy, nullptr if the level has none
+	// Positions of the other players are only used by FarthestFromPlayers
+	CSpawnPointComponent* Select(const std::vector<Vec3>& otherPlayerPositions);
+	CSpawnPointComponent* Select(ESelectionPolicy policy, const std::vector<Vec3>& otherPlayerPositions);
+
+	uint32 GetCount() const { return static_cast<uint32>(m_entries.size()); }
+	void LogStatistics();
+
+protected:
+	struct SEntry
+	{
+		CSpawnPointComponent* pSpawnPoint;
+		// Value of m_useCounter when the spawn point was last selected or registered
+		uint64 lastUse;
+	};
+
+	// Marks the spawn point at the index as used now
+	CSpawnPointComponent* Use(uint32 index);
+	CSpawnPointComponent* SelectFarthest(const std::vector<Vec3>& otherPlayerPositions);
+
+protected:
+	// Registration order, removal keeps the order of the remaining spawn points
+	std::vector<SEntry> m_entries;
+	std::unordered_map<const CSpawnPointComponent*, uint32> m_indices;
+	// Spawn points ordered by last use, the least recently used one first
+	std::set<std::pair<uint64, const CSpawnPointComponent*>> m_byLastUse;
+
+	uint64 m_useCounter = 0;
+	uint32 m_roundRobinCursor = 0;
+
+	CPointGrid m_playerGrid;
+	SStatistics m_statistics;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Two-level hierarchical timing wheel
+// Items are identified by dense handles in [0, capacity) and expire at a tick deadline.
+// Advancing costs O(ticks passed + expired items), independent of how many items are scheduled.
+////////////////////////////////////////////////////////
+class CTimingWheel
+{
+	// Inner wheel, one bucket per tick
+	static constexpr uint32 InnerBits = 8;
+	static constexpr uint32 InnerSize = 1 << InnerBits;
+	static constexpr uint32 InnerMask = InnerSize - 1;
+
+	// Outer wheel, one bucket per full turn of the inner wheel
+	static constexpr uint32 OuterBits = 6;
+	static constexpr uint32 OuterSize = 1 << OuterBits;
+	static constexpr uint32 OuterMask = OuterSize - 1;
+
+	// Longest delay that can be represented, longer delays are clamped
+	static constexpr uint32 MaxDelayTicks = InnerSize * OuterSize - 1;
+
+public:
+	static constexpr uint32 InvalidHandle = ~0u;
+
+	explicit CTimingWheel(float tickDuration = 1.f / 32.f)
+		: m_tickDuration(tickDuration)
+	{
+		m_buckets.resize(InnerSize + OuterSize, uint32(InvalidHandle));
+	}
+
+	// Makes handles [0, capacity) available, keeps items already scheduled
+	void Reserve(uint32 capacity)
+	{
+		if (capacity > m_nodes.size())
+		{
+			m_nodes.resize(capacity);
+		}
+	}
+
+	// Removes all items and rewinds the clock
+	void Clear()
+	{
+		std::fill(m_buckets.begin(), m_buckets.end(), uint32(InvalidHandle));
+		for (SNode& node : m_nodes)
+		{
+			node = SNode();
+		}
+
+		m_currentTick = 0;
+		m_accumulatedTime = 0.f;
+		m_scheduledCount = 0;
+	}
+
+	// (Re)schedules an item to expire after the given delay, rounded up to the next tick
+	void Schedule(uint32 handle, float delay)
+	{
+		Reserve(handle + 1);
+		Cancel(handle);
+
+		const float ticks = max(delay / m_tickDuration, 1.f);
+		const uint32 delayTicks = ticks < (float)MaxDelayTicks ? (uint32)ceilf(ticks) : MaxDelayTicks;
+
+		m_nodes[handle].deadline = m_currentTick + delayTicks;
+		Insert(handle);
+
+		++m_scheduledCount;
+	}
+
+	void Cancel(uint32 handle)
+	{
+		if (handle >= m_nodes.size() || !m_nodes[handle].bScheduled)
+			return;
+
+		Unlink(handle);
+		--m_scheduledCount;
+	}
+
+	bool IsScheduled(uint32 handle) const { return handle < m_nodes.size() && m_nodes[handle].bScheduled; }
+	uint32 GetScheduledCount() const { return m_scheduledCount; }
+
+	// Moves the clock forward, invoking onExpired(handle) for each item whose deadline was reached
+	// The callback is allowed to schedule or cancel items
+	template<typename TCallback>
+	void Advance(float deltaTime, TCallback&& onExpired)
+	{
+		m_accumulatedTime += deltaTime;
+
+		while (m_accumulatedTime >= m_tickDuration)
+		{
+			m_accumulatedTime -= m_tickDuration;
+			++m_currentTick;
+
+			// Entering a new turn of the inner wheel, redistribute the matching outer bucket
+			if ((m_currentTick & InnerMask) == 0)
+			{
+				Cascade(InnerSize + ((m_currentTick >> InnerBits) & OuterMask));
+			}
+
+			uint32& head = m_buckets[m_currentTick & InnerMask];
+			while (head != InvalidHandle)
+			{
+				const uint32 handle = head;
+				Unlink(handle);
+				--m_scheduledCount;
+
+				onExpired(handle);
+			}
+		}
+	}
+
+protected:
+	struct SNode
+	{
+		uint64 deadline = 0;
+		uint32 previous = InvalidHandle;
+		uint32 next = InvalidHandle;
+		uint32 bucket = InvalidHandle;
+		bool bScheduled = false;
+	};
+
+	void Insert(uint32 handle)
+	{
+		SNode& node = m_nodes[handle];
+
+		const uint64 delta = node.deadline - m_currentTick;
+		if (delta < InnerSize)
+		{
+			node.bucket = (uint32)(node.deadline & InnerMask);
+		}
+		else
+		{
+			node.bucket = InnerSize + (uint32)((node.deadline >> InnerBits) & OuterMask);
+		}
+
+		node.previous = InvalidHandle;
+		node.next = m_buckets[node.bucket];
+		if (node.next != InvalidHandle)
+		{
+			m_nodes[node.next].previous = handle;
+		}
+
+		m_buckets[node.bucket] = handle;
+		node.bScheduled = true;
+	}
+
+	void Unlink(uint32 handle)
+	{
+		SNode& node = m_nodes[handle];
+
+		if (node.previous != InvalidHandle)
+			m_nodes[node.previous].next = node.next;
+		else
+			m_buckets[node.bucket] = node.next;
+
+		if (node.next != InvalidHandle)
+			m_nodes[node.next].previous = node.previous;
+
+		node.previous = InvalidHandle;
+		node.next = InvalidHandle;
+		node.bucket = InvalidHandle;
+		node.bScheduled = false;
+	}
+
+	void Cascade(uint32 bucket)
+	{
+		uint32 handle = m_buckets[bucket];
+		m_buckets[bucket] = InvalidHandle;
+
+		while (handle != InvalidHandle)
+		{
+			const uint32 next = m_nodes[handle].next;
+			Insert(handle);
+			handle = next;
+		}
+	}
+
+protected:
+	std::vector<SNode> m_nodes;
+	std::vector<uint32> m_buckets;
+
+	float m_tickDuration;
+	float m_accumulatedTime = 0.f;
+	uint64 m_currentTick = 0;
+	uint32 m_scheduledCount = 0;
+};
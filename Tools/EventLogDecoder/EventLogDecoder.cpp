@@ -0,0 +1,78 @@
+// Turns a binary event log written by CEventLog back into text
+// Usage: EventLogDecoder <GameEvents.bin> [output.txt]
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../../Systems/EventLogFormat.h"
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <event log> [output]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* pInput = fopen(argv[1], "rb");
+	if (pInput == nullptr)
+	{
+		fprintf(stderr, "Could not open %s\n", argv[1]);
+		return 1;
+	}
+
+	EventLog::SFileHeader header;
+	if (fread(&header, sizeof(header), 1, pInput) != 1 || header.magic != EventLog::FileMagic)
+	{
+		fprintf(stderr, "%s is not an event log\n", argv[1]);
+		fclose(pInput);
+		return 1;
+	}
+	if (header.version != EventLog::FileVersion)
+	{
+		fprintf(stderr, "%s has version %u, expected %u\n", argv[1], header.version, EventLog::FileVersion);
+		fclose(pInput);
+		return 1;
+	}
+
+	std::vector<EventLog::SRecord> records;
+	EventLog::SRecord record;
+	while (fread(&record, sizeof(record), 1, pInput) == 1)
+	{
+		records.push_back(record);
+	}
+	fclose(pInput);
+
+	// Records are flushed ring by ring, restore the order in which they happened
+	std::stable_sort(records.begin(), records.end(), [](const EventLog::SRecord& a, const EventLog::SRecord& b) { return a.ticks < b.ticks; });
+
+	FILE* pOutput = argc > 2 ? fopen(argv[2], "w") : stdout;
+	if (pOutput == nullptr)
+	{
+		fprintf(stderr, "Could not open %s for writing\n", argv[2]);
+		return 1;
+	}
+
+	const uint64_t firstTicks = records.empty() ? 0 : records.front().ticks;
+	const double secondsPerTick = header.ticksPerSecond != 0 ? 1.0 / (double)header.ticksPerSecond : 0.0;
+
+	for (const EventLog::SRecord& entry : records)
+	{
+		const EventLog::SEventDesc& desc = EventLog::GetEventDesc(static_cast<EventLog::EEvent>(entry.event));
+
+		char szArgs[256];
+		snprintf(szArgs, sizeof(szArgs), desc.szFormat, (double)entry.args[0], (double)entry.args[1], (double)entry.args[2], (double)entry.args[3]);
+
+		fprintf(pOutput, "%12.6f  thread %2u  entity %8u  %-16s %s\n",
+			(double)(entry.ticks - firstTicks) * secondsPerTick, (unsigned)entry.thread, (unsigned)entry.entityId, desc.szName, szArgs);
+	}
+
+	if (pOutput != stdout)
+	{
+		fclose(pOutput);
+	}
+
+	fprintf(stderr, "%u records decoded\n", (unsigned)records.size());
+	return 0;
+}
@@ -1,14 +1,309 @@
 #include "UserSettings.h"
+#include "GamePlugin.h"
 #include <CrySystem/ISystem.h>
 #include <CrySystem/IConsole.h>
 
+static void DumpProjectilePoolStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetProjectilePool().LogStatistics();
+	}
+}
+
+static void DumpBallisticsStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetBallistics().LogStatistics();
+	}
+}
+
+static void DumpAssetStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetAssets().LogStatistics();
+	}
+}
+
+static void DumpRaycastStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetRaycasts().LogStatistics();
+	}
+}
+
+static void DumpPlayerUpdateStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetPlayerUpdate().LogStatistics();
+	}
+}
+
+static void DumpPlayerPoolStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetPlayerPool().LogStatistics();
+	}
+}
+
+static void DumpCharacterStreamerStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetCharacterStreamer().LogStatistics();
+	}
+}
+
+static void DumpSpawnStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetSpawnRegistry().LogStatistics();
+	}
+}
+
+static void DumpEventLogStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetEventLog().LogStatistics();
+	}
+}
+
+static void DumpSessionRecorderStatistics(IConsoleCmdArgs* pArgs)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		pPlugin->GetSessionRecorder().LogStatistics();
+	}
+}
+
+static void OnSessionRecordChanged(ICVar* pCVar)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		// Connected players join the recording with their next spawn or input
+		if (pCVar->GetIVal() == 0)
+			pPlugin->GetSessionRecorder().Stop();
+		else if (!pPlugin->m_players.empty())
+			pPlugin->GetSessionRecorder().Start(CSessionRecorder::DefaultPath);
+	}
+}
+
+static void OnEventLogChanged(ICVar* pCVar)
+{
+	if (CGamePlugin* pPlugin = CGamePlugin::GetInstance())
+	{
+		if (pCVar->GetIVal() != 0)
+			pPlugin->GetEventLog().Start(CEventLog::DefaultPath);
+		else
+			pPlugin->GetEventLog().Stop();
+	}
+}
+
+SGameSettings CUserSettings::s_settings;
+
+void CUserSettings::OnSpeedChanged(ICVar* pCVar)
+{
+	if (pCVar->GetFVal() < 0.f)
+	{
+		pCVar->Set(0.f);
+	}
+}
+
+void CUserSettings::OnPitchLimitChanged(ICVar* pCVar)
+{
+	// The limit being changed gives way to the other one, so that the range stays valid
+	const bool bMin = strcmp(pCVar->GetName(), "g_pitchMin") == 0;
+	const float other = bMin ? s_settings.maxPitch : s_settings.minPitch;
+
+	float limit = clamp_tpl(pCVar->GetFVal(), -gf_PI * 0.5f, gf_PI * 0.5f);
+	limit = bMin ? min(limit, other) : max(limit, other);
+
+	if (limit != pCVar->GetFVal())
+	{
+		pCVar->Set(limit);
+	}
+}
+
 void CUserSettings::RegisterCVars()
 {
-	ConsoleRegistrationHelper::RegisterFloat("g_WalkingSpeed", 15.0f, VF_RESTRICTEDMODE, "Adjust player walking speed");
+	// Bound to s_settings, values are written directly into the struct
+	SGameSettings defaults;
+	ConsoleRegistrationHelper::Register("g_WalkingSpeed", &s_settings.walkSpeed, defaults.walkSpeed, VF_RESTRICTEDMODE, "Adjust player walking speed", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_crouchSpeed", &s_settings.crouchSpeed, defaults.crouchSpeed, VF_RESTRICTEDMODE, "Adjust player crouching speed", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_rotationSpeed", &s_settings.rotationSpeed, defaults.rotationSpeed, VF_RESTRICTEDMODE, "Look rotation in radians per unit of mouse movement", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_pitchMin", &s_settings.minPitch, defaults.minPitch, VF_RESTRICTEDMODE, "Lowest look pitch in radians", OnPitchLimitChanged);
+	ConsoleRegistrationHelper::Register("g_pitchMax", &s_settings.maxPitch, defaults.maxPitch, VF_RESTRICTEDMODE, "Highest look pitch in radians", OnPitchLimitChanged);
+	ConsoleRegistrationHelper::Register("g_bulletVelocity", &s_settings.bulletVelocity, defaults.bulletVelocity, VF_RESTRICTEDMODE, "Initial speed of shot bullets in m/s", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_stoneVelocity", &s_settings.stoneVelocity, defaults.stoneVelocity, VF_RESTRICTEDMODE, "Initial speed of thrown stones in m/s", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_mouseFilter", &s_settings.mouseFilter, defaults.mouseFilter, VF_RESTRICTEDMODE, "Smoothing of mouse look input, applied per player and fixed step\n"
+		"0 = Raw, no delay\n"
+		"1 = Box filter over the last 10 steps\n"
+		"2 = Exponential, see g_mouseFilterTimeConstant\n"
+		"3 = One euro, smooth when slow and direct when fast, see g_mouseFilterMinCutoff and g_mouseFilterBeta");
+	ConsoleRegistrationHelper::Register("g_mouseFilterTimeConstant", &s_settings.mouseFilterTimeConstant, defaults.mouseFilterTimeConstant, VF_RESTRICTEDMODE, "Time constant of the exponential mouse filter in seconds", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_mouseFilterMinCutoff", &s_settings.mouseFilterMinCutoff, defaults.mouseFilterMinCutoff, VF_RESTRICTEDMODE, "Cutoff of the one euro mouse filter at rest in Hz", OnSpeedChanged);
+	ConsoleRegistrationHelper::Register("g_mouseFilterBeta", &s_settings.mouseFilterBeta, defaults.mouseFilterBeta, VF_RESTRICTEDMODE, "Cutoff increase of the one euro mouse filter in Hz per mouse unit per second", OnSpeedChanged);
+	ConsoleRegistrationHelper::AddCommand("g_mouseFilterDelay", PlayerInput::MeasureFilterDelay, VF_RESTRICTEDMODE, "Logs how long each mouse filter takes to follow a step of mouse movement at the current step rate\n"
+		"Usage: g_mouseFilterDelay [mouse delta per step = 10]");
+
+	// Projectile pool, applied the next time the pool is filled (level load)
+	ConsoleRegistrationHelper::RegisterInt("g_projectilePoolSize", 64, VF_RESTRICTEDMODE, "Number of bullet entities spawned up front for the projectile pool");
+	ConsoleRegistrationHelper::RegisterInt("g_projectilePoolOverflow", 1, VF_RESTRICTEDMODE, "What to do when the projectile pool is exhausted\n"
+		"0 = Grow the pool\n"
+		"1 = Recycle the oldest projectile in flight\n"
+		"2 = Drop the shot");
+	ConsoleRegistrationHelper::RegisterFloat("g_projectileMaxAge", 5.0f, VF_RESTRICTEDMODE, "Seconds after which a projectile in flight returns to the pool");
+	ConsoleRegistrationHelper::RegisterInt("g_projectileImpactPolicy", 2, VF_RESTRICTEDMODE, "When impacts return a projectile to the pool\n"
+		"0 = Never, only g_projectileMaxAge applies\n"
+		"1 = On first impact\n"
+		"2 = After g_projectileMaxBounces impacts");
+	ConsoleRegistrationHelper::RegisterInt("g_projectileMaxBounces", 3, VF_RESTRICTEDMODE, "Impacts after which a projectile returns to the pool, see g_projectileImpactPolicy");
+	ConsoleRegistrationHelper::RegisterInt("g_projectileMaxLive", 256, VF_RESTRICTEDMODE, "Maximum number of projectiles in flight, the oldest is reclaimed beyond that");
+	ConsoleRegistrationHelper::AddCommand("g_projectilePoolStats", DumpProjectilePoolStatistics, VF_RESTRICTEDMODE, "Logs projectile pool hits, misses, high-water mark, live count and reclaim rate");
+
+	// Analytic ballistics
+	ConsoleRegistrationHelper::RegisterInt("g_projectileBallistics", 0, VF_RESTRICTEDMODE, "Simulate bullets and stones analytically instead of as pooled rigid bodies\n"
+		"0 = Rigid bodies\n"
+		"1 = Analytic ballistics, only impacts reach the physics world");
+	ConsoleRegistrationHelper::AddCommand("g_ballisticsStats", DumpBallisticsStatistics, VF_RESTRICTEDMODE, "Logs analytic projectile count, rays and timings");
+	ConsoleRegistrationHelper::AddCommand("g_ballisticsBenchmark", CBallisticsSystem::RunBenchmark, VF_RESTRICTEDMODE, "Usage: g_ballisticsBenchmark [steps]\n"
+		"Compares analytic ballistics against rigid bodies for 1k, 10k and 100k projectiles");
+
+	ConsoleRegistrationHelper::AddCommand("g_assetStats", DumpAssetStatistics, VF_RESTRICTEDMODE, "Logs resident asset handles and path lookups issued after preloading");
+	ConsoleRegistrationHelper::AddCommand("g_playerStateBenchmark", PlayerStateMachine::RunBenchmark, VF_RESTRICTEDMODE, "Usage: g_playerStateBenchmark [players]\n"
+		"Steps the player state machine of N players (default 10000) for 100 frames, branching logic against the transition table");
+	ConsoleRegistrationHelper::AddCommand("g_raycastStats", DumpRaycastStatistics, VF_RESTRICTEDMODE, "Logs rays submitted and delivered per frame, rays in flight and batch timings");
+	ConsoleRegistrationHelper::AddCommand("g_raycastSelfTest", CRaycastService::RunSelfTest, VF_RESTRICTEDMODE, "Usage: g_raycastSelfTest [rays per frame = 256] [frames = 100]\n"
+		"Checks batching, ordering, cancelling and timeouts of the raycast service against the physics-free backend and times its overhead");
+
+	// Debug overlay categories, not available in release builds
+#if defined(GAME_DEBUG_OVERLAY)
+	CDebugOverlay::RegisterCVars();
+#endif
+
+	ConsoleRegistrationHelper::RegisterInt("g_playerAttachmentCache", 1, VF_RESTRICTEDMODE, "Resolve player attachments once per character and only apply visibility changes\n"
+		"0 = Look up by name and apply visibility on every use\n"
+		"1 = Cached handles, edge-triggered visibility");
+	ConsoleRegistrationHelper::AddCommand("g_playerAttachmentStats", CPlayerAttachments::LogStatistics, VF_RESTRICTEDMODE, "Logs attachment manager calls per player per frame since the last call, then resets the counters");
+	ConsoleRegistrationHelper::AddCommand("g_playerColliderStats", CPlayerComponent::LogColliderStatistics, VF_RESTRICTEDMODE, "Logs player collider swaps per second, deferred swaps and full rebuilds since the last call, then resets the counters");
+
+	ConsoleRegistrationHelper::RegisterInt("g_eventLog", 0, VF_RESTRICTEDMODE, "Write gameplay events to %USER%/GameEvents.bin, decode the file with EventLogDecoder\n"
+		"Restarting the log overwrites the file", OnEventLogChanged);
+	ConsoleRegistrationHelper::AddCommand("g_eventLogStats", DumpEventLogStatistics, VF_RESTRICTEDMODE, "Logs event log records written and dropped");
+
+	// Gameplay profiling markers, not available in release builds
+#if defined(GAME_PROFILER)
+	ConsoleRegistrationHelper::AddCommand("g_profileCapture", CProfiler::Capture, VF_RESTRICTEDMODE, "Records gameplay profiling markers for a number of frames and writes them as Chrome trace events\n"
+		"Usage: g_profileCapture [frames = 60] [file = %USER%/GameProfile.json]\n"
+		"Open the file in chrome://tracing");
+	ConsoleRegistrationHelper::AddCommand("g_profileStats", CProfiler::LogStatistics, VF_RESTRICTEDMODE, "Logs count, min, mean, p99 and max time per gameplay profiling marker since the last call, then resets the histograms");
+#endif
+	ConsoleRegistrationHelper::RegisterInt("g_spawnPolicy", 3, VF_RESTRICTEDMODE, "How revived players pick a spawn point\n"
+		"0 = First spawn point of the level\n"
+		"1 = Round robin\n"
+		"2 = Least recently used\n"
+		"3 = Farthest from other players, least recently used without other players");
+	ConsoleRegistrationHelper::AddCommand("g_spawnStats", DumpSpawnStatistics, VF_RESTRICTEDMODE, "Logs registered spawn points, selections and grid cells searched per selection since the last call");
+	CPlayerUpdateSystem::RegisterCVars();
+	CSimulationClock::RegisterCVars();
+	ConsoleRegistrationHelper::AddCommand("g_playerTickStats", CSimulationClock::LogStatistics, VF_RESTRICTEDMODE, "Logs fixed player steps per frame and the simulation time dropped after hitches since the last call");
+	ConsoleRegistrationHelper::AddCommand("g_playerUpdateStats", DumpPlayerUpdateStatistics, VF_RESTRICTEDMODE, "Logs players, steps and jobs per frame, the gather, simulate and apply times per step and the animation and camera time per frame of batched player updates since the last call");
+	ConsoleRegistrationHelper::AddCommand("g_playerUpdateBenchmark", CPlayerUpdateSystem::RunBenchmark, VF_RESTRICTEDMODE, "Simulates 1 to 256 players without entities on one thread and in jobs and logs the time per frame\n"
+		"Usage: g_playerUpdateBenchmark [frames = 100]");
+	// Player pool, applied the next time the pool is filled (level load)
+	ConsoleRegistrationHelper::RegisterInt("g_playerPoolSize", 4, VF_RESTRICTEDMODE, "Number of hidden player entities spawned on level load for connecting remote clients\n"
+		"Clients connecting while the pool is empty spawn their player on connection");
+	ConsoleRegistrationHelper::AddCommand("g_playerPoolStats", DumpPlayerPoolStatistics, VF_RESTRICTEDMODE, "Logs player pool hits, misses, returned players and high-water mark since the last call");
+	ConsoleRegistrationHelper::RegisterInt("g_playerStreamedLoad", 0, VF_RESTRICTEDMODE, "How spawned players load their character and Mannequin files\n"
+		"0 = Synchronously while spawning\n"
+		"1 = Streamed in the background, the player is a physics capsule buffering input until its character resources are resident");
+	ConsoleRegistrationHelper::AddCommand("g_playerLoadStats", DumpCharacterStreamerStatistics, VF_RESTRICTEDMODE, "Logs streamed player files and the time from spawning to the first controllable frame per load mode since the last call");
+	ConsoleRegistrationHelper::RegisterInt("g_netPrediction", 0, VF_RESTRICTEDMODE, "Client-side prediction of player movement\n"
+		"0 = Off\n"
+		"1 = Clients send their input to the server, which moves their player authoritatively and sends back corrections");
+	ConsoleRegistrationHelper::AddCommand("g_netPredictionStats", MovementPrediction::LogStatistics, VF_RESTRICTEDMODE, "Logs predicted, acknowledged and re-simulated movement commands and corrections since the last call");
+	ConsoleRegistrationHelper::AddCommand("g_netLoopbackTest", MovementPrediction::RunLoopbackTest, VF_RESTRICTEDMODE, "Runs movement prediction over a simulated connection and logs correction rate and re-simulation work\n"
+		"Usage: g_netLoopbackTest [round trip ms = 100] [loss percent = 5] [seconds = 60]");
+	ConsoleRegistrationHelper::RegisterInt("g_sessionRecord", 0, VF_RESTRICTEDMODE, "Record frame times, player input, spawns, projectiles and collisions to %USER%/GameSession.rec\n"
+		"Recording starts with the first client connection and stops on level unload, restarting overwrites the file", OnSessionRecordChanged);
+	ConsoleRegistrationHelper::AddCommand("g_sessionRecordStats", DumpSessionRecorderStatistics, VF_RESTRICTEDMODE, "Logs frames and records written by the session recorder");
+	ConsoleRegistrationHelper::AddCommand("g_sessionReplay", CSessionReplay::Replay, VF_RESTRICTEDMODE, "Plays a session recording back through the loaded level with its recorded input, frame times and settings,\n"
+		"then logs the replay time and the gameplay profiling markers of the replayed frames\n"
+		"Usage: g_sessionReplay [file = %USER%/GameSession.rec] [render = 1]");
+	ConsoleRegistrationHelper::AddCommand("g_animEventStats", CAnimEventStatistics::LogStatistics, VF_RESTRICTEDMODE, "Logs how often each anim event was handled and how often nobody consumed it since the last call, then resets the counters");
 }
 
 void CUserSettings::UnregisterCVars()
 {
 	IConsole *pConsole = gEnv->pConsole;
 	pConsole->UnregisterVariable("g_WalkingSpeed", true);
-}
+	pConsole->UnregisterVariable("g_crouchSpeed", true);
+	pConsole->UnregisterVariable("g_rotationSpeed", true);
+	pConsole->UnregisterVariable("g_pitchMin", true);
+	pConsole->UnregisterVariable("g_pitchMax", true);
+	pConsole->UnregisterVariable("g_bulletVelocity", true);
+	pConsole->UnregisterVariable("g_stoneVelocity", true);
+	pConsole->UnregisterVariable("g_mouseFilter", true);
+	pConsole->UnregisterVariable("g_mouseFilterTimeConstant", true);
+	pConsole->UnregisterVariable("g_mouseFilterMinCutoff", true);
+	pConsole->UnregisterVariable("g_mouseFilterBeta", true);
+	pConsole->RemoveCommand("g_mouseFilterDelay");
+
+	pConsole->UnregisterVariable("g_projectilePoolSize", true);
+	pConsole->UnregisterVariable("g_projectilePoolOverflow", true);
+	pConsole->UnregisterVariable("g_projectileMaxAge", true);
+	pConsole->UnregisterVariable("g_projectileImpactPolicy", true);
+	pConsole->UnregisterVariable("g_projectileMaxBounces", true);
+	pConsole->UnregisterVariable("g_projectileMaxLive", true);
+	pConsole->RemoveCommand("g_projectilePoolStats");
+
+	pConsole->UnregisterVariable("g_projectileBallistics", true);
+	pConsole->RemoveCommand("g_ballisticsStats");
+	pConsole->RemoveCommand("g_ballisticsBenchmark");
+
+	pConsole->RemoveCommand("g_assetStats");
+	pConsole->RemoveCommand("g_playerStateBenchmark");
+	pConsole->RemoveCommand("g_raycastStats");
+	pConsole->RemoveCommand("g_raycastSelfTest");
+
+#if defined(GAME_DEBUG_OVERLAY)
+	CDebugOverlay::UnregisterCVars();
+#endif
+
+	pConsole->UnregisterVariable("g_playerAttachmentCache", true);
+	pConsole->RemoveCommand("g_playerAttachmentStats");
+	pConsole->RemoveCommand("g_playerColliderStats");
+
+	pConsole->UnregisterVariable("g_eventLog", true);
+	pConsole->RemoveCommand("g_eventLogStats");
+
+#if defined(GAME_PROFILER)
+	pConsole->RemoveCommand("g_profileCapture");
+	pConsole->RemoveCommand("g_profileStats");
+#endif
+	CPlayerUpdateSystem::UnregisterCVars();
+	CSimulationClock::UnregisterCVars();
+	pConsole->RemoveCommand("g_playerTickStats");
+	pConsole->RemoveCommand("g_playerUpdateStats");
+	pConsole->RemoveCommand("g_playerUpdateBenchmark");
+	pConsole->UnregisterVariable("g_playerPoolSize", true);
+	pConsole->RemoveCommand("g_playerPoolStats");
+	pConsole->UnregisterVariable("g_playerStreamedLoad", true);
+	pConsole->RemoveCommand("g_playerLoadStats");
+	pConsole->UnregisterVariable("g_netPrediction", true);
+	pConsole->RemoveCommand("g_netPredictionStats");
+	pConsole->RemoveCommand("g_netLoopbackTest");
+	pConsole->UnregisterVariable("g_sessionRecord", true);
+	pConsole->RemoveCommand("g_sessionRecordStats");
+	pConsole->RemoveCommand("g_sessionReplay");
+	pConsole->RemoveCommand("g_animEventStats");
+	pConsole->UnregisterVariable("g_spawnPolicy", true);
+	pConsole->RemoveCommand("g_spawnStats");
+}
\ No newline at end of file
@@ -1,5 +1,33 @@
 #pragma once
 
+struct ICVar;
+
+// Gameplay tuning values, bound to console variables so that gameplay code reads plain fields
+// Holds the defaults until CUserSettings::RegisterCVars runs on POST_INIT
+struct SGameSettings
+{
+	// Units per second, g_WalkingSpeed and g_crouchSpeed
+	float walkSpeed = 15.0f;
+	float crouchSpeed = 10.0f;
+
+	// Radians per mouse delta unit and pitch limits in radians, g_rotationSpeed, g_pitchMin and g_pitchMax
+	float rotationSpeed = 0.002f;
+	float minPitch = -0.84f;
+	float maxPitch = 1.5f;
+
+	// Initial speed in m/s of shot bullets and thrown stones, g_bulletVelocity and g_stoneVelocity
+	float bulletVelocity = 10.0f;
+	float stoneVelocity = 50.0f;
+
+	// Mouse smoothing, g_mouseFilter as a PlayerInput::EFilter, box filter by default
+	int mouseFilter = 1;
+	// Seconds, g_mouseFilterTimeConstant of the exponential filter
+	float mouseFilterTimeConstant = 0.03f;
+	// Hz and Hz per mouse unit per second, g_mouseFilterMinCutoff and g_mouseFilterBeta of the one euro filter
+	float mouseFilterMinCutoff = 2.0f;
+	float mouseFilterBeta = 0.01f;
+};
+
 class CUserSettings
 {
 public:
@@ -9,4 +37,12 @@ public:
 	void RegisterCVars();
 	void UnregisterCVars();
 
-};
\ No newline at end of file
+	static const SGameSettings& Get() { return s_settings; }
+
+protected:
+	// Change callbacks keeping the bound values in range
+	static void OnSpeedChanged(ICVar* pCVar);
+	static void OnPitchLimitChanged(ICVar* pCVar);
+
+	static SGameSettings s_settings;
+};